@@ -0,0 +1,79 @@
+#include "AllocationCounter.h"
+
+#ifdef COUNT_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+//Replaces every form of the global operator new and delete, so frames can be checked for heap allocations
+//All of them are replaced, a toolchain or sanitizer may bring its own for any form left out
+
+namespace
+{
+	std::atomic<uint64_t> g_AllocationCount{};
+
+	void* Allocate(size_t size)
+	{
+		g_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+		return std::malloc(size == 0 ? 1 : size);
+	}
+
+	void* AllocateAligned(size_t size, std::align_val_t alignment)
+	{
+		g_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+		const size_t alignmentBytes{ size_t(alignment) };
+#ifdef _MSC_VER
+		return _aligned_malloc(size == 0 ? 1 : size, alignmentBytes);
+#else
+		//aligned_alloc wants a multiple of the alignment
+		return std::aligned_alloc(alignmentBytes, (size + alignmentBytes) / alignmentBytes * alignmentBytes);
+#endif
+	}
+
+	void FreeAligned(void* pMemory)
+	{
+#ifdef _MSC_VER
+		_aligned_free(pMemory);
+#else
+		std::free(pMemory);
+#endif
+	}
+
+	void* ThrowIfNull(void* pMemory)
+	{
+		if (!pMemory)
+			throw std::bad_alloc{};
+		return pMemory;
+	}
+}
+
+uint64_t dae::AllocationCounter::GetCount()
+{
+	return g_AllocationCount.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size) { return ThrowIfNull(Allocate(size)); }
+void* operator new[](size_t size) { return ThrowIfNull(Allocate(size)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return Allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return Allocate(size); }
+
+void* operator new(size_t size, std::align_val_t alignment) { return ThrowIfNull(AllocateAligned(size, alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return ThrowIfNull(AllocateAligned(size, alignment)); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return AllocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return AllocateAligned(size, alignment); }
+
+void operator delete(void* pMemory) noexcept { std::free(pMemory); }
+void operator delete[](void* pMemory) noexcept { std::free(pMemory); }
+void operator delete(void* pMemory, size_t) noexcept { std::free(pMemory); }
+void operator delete[](void* pMemory, size_t) noexcept { std::free(pMemory); }
+void operator delete(void* pMemory, const std::nothrow_t&) noexcept { std::free(pMemory); }
+void operator delete[](void* pMemory, const std::nothrow_t&) noexcept { std::free(pMemory); }
+
+void operator delete(void* pMemory, std::align_val_t) noexcept { FreeAligned(pMemory); }
+void operator delete[](void* pMemory, std::align_val_t) noexcept { FreeAligned(pMemory); }
+void operator delete(void* pMemory, size_t, std::align_val_t) noexcept { FreeAligned(pMemory); }
+void operator delete[](void* pMemory, size_t, std::align_val_t) noexcept { FreeAligned(pMemory); }
+void operator delete(void* pMemory, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(pMemory); }
+void operator delete[](void* pMemory, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(pMemory); }
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+
+//Replaces the global operator new and delete with counting ones, for Benchmark::FrameAllocations
+//Off by default, every allocation of the process would pay for an atomic and leak checkers like VLD would be bypassed
+// >> Uncomment, or define it for the build, to count
+//#define COUNT_ALLOCATIONS
+
+namespace dae
+{
+	//Every operator new of the process, including those of other threads and libraries
+	namespace AllocationCounter
+	{
+#ifdef COUNT_ALLOCATIONS
+		constexpr bool IsEnabled() { return true; }
+		uint64_t GetCount();
+#else
+		constexpr bool IsEnabled() { return false; }
+		inline uint64_t GetCount() { return 0; }
+#endif
+	}
+}
@@ -0,0 +1,125 @@
+#include "BatchRender.h"
+
+//External includes
+#include <SDL_surface.h>
+
+//Standard includes
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+//Project includes
+#include "CameraPath.h"
+#include "Renderer.h"
+#include "TextureManager.h"
+#include "Y4MWriter.h"
+
+namespace dae
+{
+	namespace
+	{
+		//Offline frames must not show placeholders, a texture that failed to load fails the whole render
+		bool WaitForTextures(Renderer& renderer)
+		{
+			const uint32_t failedCount{ renderer.WaitForTextures() };
+			if (failedCount > 0)
+				std::cerr << "Could not load " << failedCount << " textures, nothing was rendered\n";
+			return failedCount == 0;
+		}
+
+		//Renders every keyframe and hands the pixels to outputFrame, returns the seconds it took
+		template<typename Function>
+		double RenderFrames(const CameraPath& cameraPath, Renderer& renderer, Function&& outputFrame)
+		{
+			const auto start{ std::chrono::high_resolution_clock::now() };
+			for (size_t frame{}; frame < cameraPath.GetFrameCount(); ++frame)
+			{
+				cameraPath.Apply(frame, renderer.GetCamera());
+				TextureManager::GetShared().Update();
+				renderer.Update(nullptr);
+				renderer.Render();
+
+				if (!outputFrame(frame, renderer.GetPixels()))
+					break;
+			}
+			return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		}
+	}
+
+	bool BatchRender::RenderCameraPath(const std::string& cameraPathFile, const std::string& outputPrefix, int width, int height,
+		ImageFormat format, uint32_t workerCount, bool isPinned)
+	{
+		CameraPath cameraPath{};
+		if (!cameraPath.LoadFromFile(cameraPathFile))
+			return false;
+
+		Renderer renderer{ width, height, workerCount, isPinned };
+		if (!WaitForTextures(renderer))
+			return false;
+
+		//Encoding, png especially, is slower than rendering, one frame more than encoders keeps them all busy
+		const uint32_t encoderCount{ std::max(std::thread::hardware_concurrency() / 2, 1u) };
+		FrameWriter frameWriter{ width, height, renderer.GetBackBuffer()->format, format, encoderCount + 1, encoderCount };
+
+		double seconds{ RenderFrames(cameraPath, renderer, [&](size_t frame, const uint32_t* pPixels)
+			{
+				char fileName[16]{};
+				std::snprintf(fileName, sizeof(fileName), "%05zu.", frame);
+				frameWriter.Submit(pPixels, outputPrefix + fileName + FrameWriter::GetExtension(format));
+				return true;
+			}) };
+
+		const auto start{ std::chrono::high_resolution_clock::now() };
+		frameWriter.WaitIdle();
+		seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+		if (frameWriter.GetFailedCount() > 0)
+		{
+			std::cerr << "Could not write " << frameWriter.GetFailedCount() << " frames to " << outputPrefix << '\n';
+			return false;
+		}
+
+		std::cerr << "Rendered " << cameraPath.GetFrameCount() << " frames of " << width << "x" << height
+			<< " in " << seconds << " s\n";
+		return true;
+	}
+
+	bool BatchRender::RenderCameraPathToY4M(const std::string& cameraPathFile, const std::string& outputPath, int width, int height,
+		int frameRate, uint32_t workerCount, bool isPinned)
+	{
+		CameraPath cameraPath{};
+		if (!cameraPath.LoadFromFile(cameraPathFile))
+			return false;
+
+		Renderer renderer{ width, height, workerCount, isPinned };
+		if (!WaitForTextures(renderer))
+			return false;
+
+		Y4MWriter writer{ outputPath, width, height, renderer.GetBackBuffer()->format, frameRate };
+		if (!writer.IsOpen())
+		{
+			std::cerr << "Could not open " << outputPath << '\n';
+			return false;
+		}
+
+		bool isWritten{ true };
+		const double seconds{ RenderFrames(cameraPath, renderer, [&](size_t, const uint32_t* pPixels)
+			{
+				isWritten = writer.WriteFrame(pPixels);
+				return isWritten;
+			}) };
+
+		//Diagnostics go to stderr in every mode, stdout may carry the video
+		if (!isWritten)
+		{
+			std::cerr << "Writing to " << outputPath << " failed, the reader may have closed the pipe\n";
+			return false;
+		}
+
+		std::cerr << "Streamed " << cameraPath.GetFrameCount() << " frames of " << width << "x" << height
+			<< " in " << seconds << " s\n";
+		return true;
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "FrameWriter.h"
+
+namespace dae
+{
+	namespace BatchRender
+	{
+		//Renders every keyframe of a camera path headlessly, as fast as possible
+		//Frame n is written to <outputPrefix><n, five digits>.<format> by encoder threads while later frames render
+		bool RenderCameraPath(const std::string& cameraPathFile, const std::string& outputPrefix, int width, int height,
+			ImageFormat format = ImageFormat::BMP, uint32_t workerCount = 0, bool isPinned = false);
+
+		//Streams every keyframe as one Y4M video to outputPath, "-" for stdout, without any intermediate files
+		bool RenderCameraPathToY4M(const std::string& cameraPathFile, const std::string& outputPath, int width, int height,
+			int frameRate = 30, uint32_t workerCount = 0, bool isPinned = false);
+	}
+}
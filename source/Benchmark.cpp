@@ -0,0 +1,463 @@
+#include "Benchmark.h"
+
+//External includes
+#include <SDL_image.h>
+
+//Standard includes
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+//Project includes
+#include "AllocationCounter.h"
+#include "DepthBuffer.h"
+#include "FrameArena.h"
+#include "Math.h"
+#include "Renderer.h"
+#include "TextureManager.h"
+#include "Texture.h"
+#include "Timer.h"
+
+namespace dae
+{
+	namespace
+	{
+		//Fixed seed so every run samples the same uvs
+		std::vector<Vector2> GenerateUVs(uint32_t count)
+		{
+			std::vector<Vector2> uvs{};
+			uvs.reserve(count);
+
+			uint32_t state{ 0x12345678u };
+			const auto next = [&state]()
+			{
+				state = state * 1664525u + 1013904223u;
+				return float(state >> 8) / float(1u << 24);
+			};
+
+			for (uint32_t i{}; i < count; ++i)
+			{
+				const float u{ next() };
+				const float v{ next() };
+				uvs.emplace_back(u, v);
+			}
+
+			return uvs;
+		}
+
+		//Wraps into [0, 1), rounding can make value - floor(value) land on 1
+		float Fract(float value)
+		{
+			return std::min(value - std::floor(value), 0.99999994f);
+		}
+
+		//One texel per step along lines rotated by angle, neighbouring lines one texel apart
+		std::vector<Vector2> GenerateRotatedUVs(uint32_t count, float angle, int width, int height)
+		{
+			std::vector<Vector2> uvs{};
+			uvs.reserve(count);
+
+			const Vector2 step{ std::cos(angle) / float(width), std::sin(angle) / float(height) };
+			const Vector2 lineStep{ -std::sin(angle) / float(width), std::cos(angle) / float(height) };
+			const uint32_t samplesPerLine{ uint32_t(std::max(width, height)) };
+
+			for (uint32_t i{}; i < count; ++i)
+			{
+				const float line{ float(i / samplesPerLine) };
+				const float sample{ float(i % samplesPerLine) };
+				uvs.emplace_back(Fract(.5f + lineStep.x * line + step.x * sample), Fract(.5f + lineStep.y * line + step.y * sample));
+			}
+
+			return uvs;
+		}
+
+		template<typename Function>
+		double MeasureSeconds(Function&& function)
+		{
+			const auto start{ std::chrono::high_resolution_clock::now() };
+			function();
+			const auto end{ std::chrono::high_resolution_clock::now() };
+			return std::chrono::duration<double>(end - start).count();
+		}
+
+		void PrintResult(const std::string& name, uint32_t count, double seconds, float checksum)
+		{
+			std::cout << "  " << name << ": " << (double(count) / seconds) / 1'000'000.0 << " Msamples/s"
+				<< " (" << seconds * 1000.0 << " ms, checksum " << checksum << ")\n";
+		}
+	}
+
+	void Benchmark::RunAll()
+	{
+		TextureSampling("resources/uv_grid_2.png");
+		TextureSampling("resources/vehicle_diffuse.png");
+		TextureLayouts("resources/vehicle_diffuse.png");
+		TextureFormats("resources/vehicle_normal.png");
+		TextureFormats("resources/vehicle_specular.png");
+		DepthFormats();
+		HeadlessFrames();
+		WorkerScaling();
+		FrameAllocations();
+	}
+
+	void Benchmark::TextureSampling(const std::string& path, uint32_t sampleCount)
+	{
+		std::cout << "Texture sampling - " << path << '\n';
+
+		Texture* pTexture{ Texture::LoadFromFile(path) };
+		SDL_Surface* pLoaded{ IMG_Load(path.c_str()) };
+		if (!pTexture || !pLoaded)
+		{
+			std::cout << "  Could not load texture\n";
+			delete pTexture;
+			SDL_FreeSurface(pLoaded);
+			return;
+		}
+
+		//Reference path: 32-bit surface, SDL_GetRGB and three divisions per sample
+		SDL_Surface* pSurface{ SDL_ConvertSurfaceFormat(pLoaded, SDL_PIXELFORMAT_ARGB8888, 0) };
+		SDL_FreeSurface(pLoaded);
+		if (!pSurface)
+		{
+			delete pTexture;
+			return;
+		}
+
+		const std::vector<Vector2> uvs{ GenerateUVs(sampleCount) };
+
+		float checksum{};
+		const double referenceSeconds{ MeasureSeconds([&]()
+		{
+			const uint32_t* pPixels{ static_cast<const uint32_t*>(pSurface->pixels) };
+			const int pitch{ pSurface->pitch / int(sizeof(uint32_t)) };
+			for (const Vector2& uv : uvs)
+			{
+				Uint8 r{}, g{}, b{};
+				const size_t x{ static_cast<size_t>(uv.x * pSurface->w) };
+				const size_t y{ static_cast<size_t>(uv.y * pSurface->h) };
+				SDL_GetRGB(pPixels[x + (y * pitch)], pSurface->format, &r, &g, &b);
+				checksum += float(r) / 255.f + float(g) / 255.f + float(b) / 255.f;
+			}
+		}) };
+		PrintResult("SDL_GetRGB", sampleCount, referenceSeconds, checksum);
+
+		checksum = 0.f;
+		const double sampleSeconds{ MeasureSeconds([&]()
+		{
+			for (const Vector2& uv : uvs)
+			{
+				const ColorRGB color{ pTexture->Sample(uv) };
+				checksum += color.r + color.g + color.b;
+			}
+		}) };
+		PrintResult("Texture::Sample", sampleCount, sampleSeconds, checksum);
+
+		//Filtered paths, one call per uv against one call per span of eight
+		const auto measureFilter = [&](TextureFilter filter, const std::string& name, float lod)
+		{
+			pTexture->SetFilter(filter);
+
+			checksum = 0.f;
+			const double scalarSeconds{ MeasureSeconds([&]()
+			{
+				for (const Vector2& uv : uvs)
+				{
+					const ColorRGB color{ pTexture->Sample(uv, lod) };
+					checksum += color.r + color.g + color.b;
+				}
+			}) };
+			PrintResult("Texture::Sample (" + name + ")", sampleCount, scalarSeconds, checksum);
+
+			checksum = 0.f;
+			const double spanSeconds{ MeasureSeconds([&]()
+			{
+				ColorRGB colors[8]{};
+				for (size_t first{}; first + 8 <= uvs.size(); first += 8)
+				{
+					pTexture->SampleSpan(&uvs[first], lod, colors, 8);
+					for (const ColorRGB& color : colors)
+						checksum += color.r + color.g + color.b;
+				}
+			}) };
+			PrintResult("Texture::SampleSpan (" + name + ")", sampleCount, spanSeconds, checksum);
+		};
+
+		measureFilter(TextureFilter::Bilinear, "bilinear", 0.f);
+		measureFilter(TextureFilter::Trilinear, "trilinear, lod 2.5", 2.5f);
+
+		SDL_FreeSurface(pSurface);
+		delete pTexture;
+	}
+
+	void Benchmark::TextureLayouts(const std::string& path, uint32_t sampleCount)
+	{
+		std::cout << "Texture layouts - " << path << " (ns/sample, lower means fewer cache misses)\n";
+
+		const std::array<std::pair<TexelLayout, const char*>, 4> layouts
+		{ {
+			{ TexelLayout::Linear, "Linear" },
+			{ TexelLayout::Tiled4x4, "Tiled4x4" },
+			{ TexelLayout::Tiled8x8, "Tiled8x8" },
+			{ TexelLayout::Morton, "Morton" }
+		} };
+
+		std::array<const Texture*, 4> textures{};
+		for (size_t i{}; i < layouts.size(); ++i)
+			textures[i] = Texture::LoadFromFile(path, layouts[i].first);
+
+		if (std::find(textures.begin(), textures.end(), nullptr) == textures.end())
+		{
+			std::cout << "  angle";
+			for (const auto& layout : layouts)
+				std::cout << std::setw(12) << layout.second;
+			std::cout << '\n';
+
+			for (const float angle : { 0.f, 30.f, 45.f, 60.f, 90.f })
+			{
+				const std::vector<Vector2> uvs{ GenerateRotatedUVs(sampleCount, angle * TO_RADIANS, textures[0]->GetWidth(), textures[0]->GetHeight()) };
+
+				std::cout << "  " << std::setw(5) << angle;
+				for (const Texture* pTexture : textures)
+				{
+					float checksum{};
+					const double seconds{ MeasureSeconds([&]()
+					{
+						for (const Vector2& uv : uvs)
+						{
+							const ColorRGB color{ pTexture->Sample(uv) };
+							checksum += color.r + color.g + color.b;
+						}
+					}) };
+					std::cout << std::setw(12) << std::fixed << std::setprecision(2) << (seconds * 1e9) / double(sampleCount)
+						<< std::defaultfloat << std::setprecision(6);
+					if (checksum < 0.f)
+						std::cout << '!';
+				}
+				std::cout << '\n';
+			}
+		}
+		else
+		{
+			std::cout << "  Could not load texture\n";
+		}
+
+		for (const Texture* pTexture : textures)
+			delete pTexture;
+	}
+
+	void Benchmark::TextureFormats(const std::string& path, uint32_t sampleCount)
+	{
+		std::cout << "Texture formats - " << path << '\n';
+
+		const std::array<std::pair<TextureFormat, const char*>, 4> formats
+		{ {
+			{ TextureFormat::RGBA8, "RGBA8" },
+			{ TextureFormat::BC1, "BC1" },
+			{ TextureFormat::BC3, "BC3" },
+			{ TextureFormat::BC5, "BC5" }
+		} };
+
+		const std::vector<Vector2> uvs{ GenerateUVs(sampleCount) };
+
+		for (const auto& format : formats)
+		{
+			Texture* pTexture{ Texture::LoadFromFile(path, format.first) };
+			if (!pTexture)
+			{
+				std::cout << "  Could not load texture\n";
+				return;
+			}
+			pTexture->SetFilter(TextureFilter::Bilinear);
+
+			float checksum{};
+			const double seconds{ MeasureSeconds([&]()
+			{
+				ColorRGB colors[8]{};
+				for (size_t first{}; first + 8 <= uvs.size(); first += 8)
+				{
+					pTexture->SampleSpan(&uvs[first], 0.f, colors, 8);
+					for (const ColorRGB& color : colors)
+						checksum += color.r + color.g + color.b;
+				}
+			}) };
+
+			std::cout << "  " << format.second << ": " << pTexture->GetMemorySize() / 1024 << " KiB,";
+			PrintResult("Texture::SampleSpan", sampleCount, seconds, checksum);
+
+			delete pTexture;
+		}
+	}
+
+	void Benchmark::DepthFormats(int width, int height, int layerCount)
+	{
+		std::cout << "Depth formats - " << width << "x" << height << ", " << layerCount << " layers\n";
+
+		constexpr float nearPlane{ .1f };
+		constexpr float farPlane{ 100.f };
+
+		//Every layer covers the screen once at depths spread log uniformly between the planes, so about half the tests pass
+		const size_t pixelCount{ size_t(width) * height };
+		std::vector<float> depths(pixelCount);
+		uint32_t state{ 0x12345678u };
+		const auto next = [&state]()
+		{
+			state = state * 1664525u + 1013904223u;
+			return float(state >> 8) / float(1u << 24);
+		};
+		for (float& depth : depths)
+			depth = nearPlane * std::pow(farPlane / nearPlane, next());
+
+		const std::array<std::pair<DepthFormat, const char*>, 3> formats
+		{ {
+			{ DepthFormat::Float32, "float32" },
+			{ DepthFormat::Unorm24, "unorm24" },
+			{ DepthFormat::Unorm16, "unorm16" }
+		} };
+
+		for (const auto& format : formats)
+		{
+			for (const bool isReversed : { false, true })
+			{
+				DepthBuffer depthBuffer{ width, height, format.first, isReversed, nearPlane, farPlane };
+
+				uint32_t passCount{};
+				const double seconds{ MeasureSeconds([&]()
+				{
+					for (int layer{}; layer < layerCount; ++layer)
+					{
+						//Shift the layer so the same pixel doesn't always get the same depth
+						size_t depthIndex{ (size_t(layer) * 7919) % pixelCount };
+						for (size_t i{}; i < pixelCount; ++i)
+						{
+							passCount += uint32_t(depthBuffer.TestAndWrite(i, depths[depthIndex]));
+							if (++depthIndex == pixelCount)
+								depthIndex = 0;
+						}
+					}
+				}) };
+
+				//Quality: pairs a relative 0.01% apart, how many still store different values
+				const auto resolvedPercentage = [&](float minDepth, float maxDepth)
+				{
+					uint32_t resolvedCount{};
+					constexpr uint32_t pairCount{ 10000 };
+					for (uint32_t i{}; i < pairCount; ++i)
+					{
+						const float depth{ minDepth * std::pow(maxDepth / minDepth, float(i) / float(pairCount)) };
+						resolvedCount += uint32_t(depthBuffer.Encode(depth) != depthBuffer.Encode(depth * 1.0001f));
+					}
+					return 100.f * float(resolvedCount) / float(pairCount);
+				};
+
+				std::cout << "  " << format.second << (isReversed ? " reversed" : "         ") << ": "
+					<< std::fixed << std::setprecision(2) << (seconds * 1e9) / (double(pixelCount) * layerCount) << " ns/test, "
+					<< depthBuffer.GetSize() / (1024 * 1024) << " MiB, resolved 0.01% steps"
+					<< " near " << resolvedPercentage(nearPlane, 1.f) << "%"
+					<< " mid " << resolvedPercentage(1.f, 10.f) << "%"
+					<< " far " << resolvedPercentage(10.f, farPlane * .9999f) << "%"
+					<< std::defaultfloat << std::setprecision(6) << " (" << passCount << " passed)\n";
+			}
+		}
+	}
+
+	void Benchmark::HeadlessFrames(int width, int height, uint32_t frameCount)
+	{
+		std::cout << "Headless frames - " << width << "x" << height << '\n';
+
+		Renderer renderer{ width, height };
+		renderer.WaitForTextures();
+
+		for (const bool isPipelined : { false, true })
+		{
+			renderer.SetFramePipelining(isPipelined);
+
+			Timer timer{};
+			const double seconds{ MeasureSeconds([&]()
+			{
+				for (uint32_t frame{}; frame < frameCount; ++frame)
+				{
+					TextureManager::GetShared().Update();
+					renderer.Update(&timer);
+					renderer.Render();
+				}
+			}) };
+
+			std::cout << "  " << (isPipelined ? "pipelined: " : "serial:    ") << std::fixed << std::setprecision(2)
+				<< (seconds * 1000.0) / double(frameCount) << " ms/frame, "
+				<< double(frameCount) / seconds << " fps" << std::defaultfloat << std::setprecision(6) << '\n';
+		}
+	}
+
+	void Benchmark::WorkerScaling(int width, int height, uint32_t frameCount)
+	{
+		std::cout << "Worker scaling - " << width << "x" << height << '\n';
+
+		const uint32_t maxWorkerCount{ std::max(std::thread::hardware_concurrency(), 2u) - 1 };
+		for (uint32_t workerCount{ 1 }; ; workerCount = std::min(workerCount * 2, maxWorkerCount))
+		{
+			Renderer renderer{ width, height, workerCount };
+			renderer.WaitForTextures();
+
+			Timer timer{};
+			const double seconds{ MeasureSeconds([&]()
+			{
+				for (uint32_t frame{}; frame < frameCount; ++frame)
+				{
+					TextureManager::GetShared().Update();
+					renderer.Update(&timer);
+					renderer.Render();
+				}
+			}) };
+
+			std::cout << "  " << std::setw(3) << workerCount << " workers: " << std::fixed << std::setprecision(2)
+				<< (seconds * 1000.0) / double(frameCount) << " ms/frame" << std::defaultfloat << std::setprecision(6) << '\n';
+
+			if (workerCount == maxWorkerCount)
+				break;
+		}
+	}
+
+	void Benchmark::FrameAllocations(int width, int height, uint32_t frameCount)
+	{
+		std::cout << "Frame allocations - " << width << "x" << height << '\n';
+		if (!AllocationCounter::IsEnabled())
+		{
+			std::cout << "  Not counted, build with COUNT_ALLOCATIONS\n";
+			return;
+		}
+
+		Renderer renderer{ width, height };
+		renderer.WaitForTextures();
+
+		for (const bool isPipelined : { false, true })
+		{
+			renderer.SetFramePipelining(isPipelined);
+
+			//The first frames size the arenas, job queues and vertex buffers
+			for (uint32_t frame{}; frame < 3; ++frame)
+			{
+				TextureManager::GetShared().Update();
+				renderer.Update(nullptr);
+				renderer.Render();
+			}
+
+			const uint64_t allocationCount{ AllocationCounter::GetCount() };
+			const uint64_t blockCount{ renderer.GetFrameArena().GetBlockAllocationCount() };
+			for (uint32_t frame{}; frame < frameCount; ++frame)
+			{
+				TextureManager::GetShared().Update();
+				renderer.Update(nullptr);
+				renderer.Render();
+			}
+
+			std::cout << "  " << (isPipelined ? "pipelined: " : "serial:    ") << std::fixed << std::setprecision(2)
+				<< double(AllocationCounter::GetCount() - allocationCount) / double(frameCount) << " allocations/frame, "
+				<< renderer.GetFrameArena().GetBlockAllocationCount() - blockCount << " arena blocks added, "
+				<< renderer.GetFrameArena().GetCapacity() / 1024 << " KiB arena" << std::defaultfloat << std::setprecision(6) << '\n';
+		}
+	}
+}
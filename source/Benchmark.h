@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace dae
+{
+	namespace Benchmark
+	{
+		//Runs every microbenchmark below on the default resources and prints the results
+		void RunAll();
+
+		//Texture::Sample throughput compared to sampling through SDL_GetRGB per texel
+		void TextureSampling(const std::string& path, uint32_t sampleCount = 1u << 24);
+
+		//Texture::Sample throughput per TexelLayout while walking the texture along rotated lines
+		void TextureLayouts(const std::string& path, uint32_t sampleCount = 1u << 22);
+
+		//Memory and bilinear span throughput of every TextureFormat
+		void TextureFormats(const std::string& path, uint32_t sampleCount = 1u << 22);
+
+		//DepthBuffer::TestAndWrite throughput and depth resolution of every DepthFormat, normal and reversed
+		void DepthFormats(int width = 1920, int height = 1080, int layerCount = 8);
+
+		//Frame time of a headless Renderer, serial and pipelined, no window or display needed
+		void HeadlessFrames(int width = 1920, int height = 1080, uint32_t frameCount = 100);
+
+		//Headless frame time per JobSystem worker count, doubling up to the hardware threads
+		void WorkerScaling(int width = 1920, int height = 1080, uint32_t frameCount = 50);
+
+		//Heap allocations per steady headless frame, serial and pipelined, should be none
+		//Only counted in builds with COUNT_ALLOCATIONS, see AllocationCounter.h
+		void FrameAllocations(int width = 1920, int height = 1080, uint32_t frameCount = 100);
+	}
+}
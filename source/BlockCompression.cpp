@@ -0,0 +1,291 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace dae
+{
+	namespace
+	{
+		constexpr int g_TexelsPerBlock{ 16 };
+
+		uint8_t Channel(uint32_t texel, int shift)
+		{
+			return uint8_t((texel >> shift) & 0xFF);
+		}
+
+		uint32_t Pack(uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+		{
+			return r | (g << 8) | (b << 16) | (a << 24);
+		}
+
+		uint16_t ToRGB565(uint32_t r, uint32_t g, uint32_t b)
+		{
+			return uint16_t((((r * 31 + 127) / 255) << 11) | (((g * 63 + 127) / 255) << 5) | ((b * 31 + 127) / 255));
+		}
+
+		void FromRGB565(uint16_t color, uint32_t& r, uint32_t& g, uint32_t& b)
+		{
+			const uint32_t r5{ uint32_t(color >> 11) & 0x1F };
+			const uint32_t g6{ uint32_t(color >> 5) & 0x3F };
+			const uint32_t b5{ uint32_t(color) & 0x1F };
+			r = (r5 << 3) | (r5 >> 2);
+			g = (g6 << 2) | (g6 >> 4);
+			b = (b5 << 3) | (b5 >> 2);
+		}
+
+		//The four RGB palette entries of a color block, opaque
+		void ColorPalette(uint16_t color0, uint16_t color1, bool isFourColor, uint32_t* pPalette)
+		{
+			uint32_t r0{}, g0{}, b0{}, r1{}, g1{}, b1{};
+			FromRGB565(color0, r0, g0, b0);
+			FromRGB565(color1, r1, g1, b1);
+
+			pPalette[0] = Pack(r0, g0, b0, 255);
+			pPalette[1] = Pack(r1, g1, b1, 255);
+			if (isFourColor)
+			{
+				pPalette[2] = Pack((2 * r0 + r1) / 3, (2 * g0 + g1) / 3, (2 * b0 + b1) / 3, 255);
+				pPalette[3] = Pack((r0 + 2 * r1) / 3, (g0 + 2 * g1) / 3, (b0 + 2 * b1) / 3, 255);
+			}
+			else
+			{
+				pPalette[2] = Pack((r0 + r1) / 2, (g0 + g1) / 2, (b0 + b1) / 2, 255);
+				pPalette[3] = 0;
+			}
+		}
+
+		//The eight values of a single channel block
+		void ChannelPalette(uint8_t value0, uint8_t value1, uint8_t* pPalette)
+		{
+			pPalette[0] = value0;
+			pPalette[1] = value1;
+			if (value0 > value1)
+			{
+				for (int i{ 1 }; i < 7; ++i)
+					pPalette[i + 1] = uint8_t(((7 - i) * value0 + i * value1) / 7);
+			}
+			else
+			{
+				for (int i{ 1 }; i < 5; ++i)
+					pPalette[i + 1] = uint8_t(((5 - i) * value0 + i * value1) / 5);
+				pPalette[6] = 0;
+				pPalette[7] = 255;
+			}
+		}
+
+		//Bounding box endpoints, every texel picks the closest palette entry
+		void EncodeColorBlock(const uint32_t* pTexels, uint8_t* pBlock)
+		{
+			uint32_t minR{ 255 }, minG{ 255 }, minB{ 255 };
+			uint32_t maxR{}, maxG{}, maxB{};
+			for (int i{}; i < g_TexelsPerBlock; ++i)
+			{
+				minR = std::min<uint32_t>(minR, Channel(pTexels[i], 0));
+				minG = std::min<uint32_t>(minG, Channel(pTexels[i], 8));
+				minB = std::min<uint32_t>(minB, Channel(pTexels[i], 16));
+				maxR = std::max<uint32_t>(maxR, Channel(pTexels[i], 0));
+				maxG = std::max<uint32_t>(maxG, Channel(pTexels[i], 8));
+				maxB = std::max<uint32_t>(maxB, Channel(pTexels[i], 16));
+			}
+
+			//Pick the box diagonal the colors run along, channels falling against red swap their ends
+			float meanR{}, meanG{}, meanB{};
+			for (int i{}; i < g_TexelsPerBlock; ++i)
+			{
+				meanR += Channel(pTexels[i], 0);
+				meanG += Channel(pTexels[i], 8);
+				meanB += Channel(pTexels[i], 16);
+			}
+			meanR /= g_TexelsPerBlock;
+			meanG /= g_TexelsPerBlock;
+			meanB /= g_TexelsPerBlock;
+
+			float covarianceRG{}, covarianceRB{};
+			for (int i{}; i < g_TexelsPerBlock; ++i)
+			{
+				const float r{ Channel(pTexels[i], 0) - meanR };
+				covarianceRG += r * (Channel(pTexels[i], 8) - meanG);
+				covarianceRB += r * (Channel(pTexels[i], 16) - meanB);
+			}
+			if (covarianceRG < 0.f)
+				std::swap(minG, maxG);
+			if (covarianceRB < 0.f)
+				std::swap(minB, maxB);
+
+			uint16_t color0{ ToRGB565(maxR, maxG, maxB) };
+			uint16_t color1{ ToRGB565(minR, minG, minB) };
+			//color0 > color1 selects the four color mode
+			if (color0 < color1)
+				std::swap(color0, color1);
+
+			uint32_t palette[4]{};
+			ColorPalette(color0, color1, true, palette);
+
+			uint32_t indices{};
+			if (color0 != color1)
+			{
+				for (int i{}; i < g_TexelsPerBlock; ++i)
+				{
+					uint32_t bestIndex{};
+					int bestDistance{ INT32_MAX };
+					for (uint32_t entry{}; entry < 4; ++entry)
+					{
+						const int dr{ int(Channel(pTexels[i], 0)) - int(Channel(palette[entry], 0)) };
+						const int dg{ int(Channel(pTexels[i], 8)) - int(Channel(palette[entry], 8)) };
+						const int db{ int(Channel(pTexels[i], 16)) - int(Channel(palette[entry], 16)) };
+						const int distance{ dr * dr + dg * dg + db * db };
+						if (distance < bestDistance)
+						{
+							bestDistance = distance;
+							bestIndex = entry;
+						}
+					}
+					indices |= bestIndex << (i * 2);
+				}
+			}
+
+			std::memcpy(pBlock, &color0, sizeof(color0));
+			std::memcpy(pBlock + 2, &color1, sizeof(color1));
+			std::memcpy(pBlock + 4, &indices, sizeof(indices));
+		}
+
+		void DecodeColorBlock(const uint8_t* pBlock, bool allowThreeColor, uint32_t* pTexels)
+		{
+			uint16_t color0{}, color1{};
+			uint32_t indices{};
+			std::memcpy(&color0, pBlock, sizeof(color0));
+			std::memcpy(&color1, pBlock + 2, sizeof(color1));
+			std::memcpy(&indices, pBlock + 4, sizeof(indices));
+
+			uint32_t palette[4]{};
+			ColorPalette(color0, color1, !allowThreeColor || color0 > color1, palette);
+
+			for (int i{}; i < g_TexelsPerBlock; ++i)
+				pTexels[i] = palette[(indices >> (i * 2)) & 0x3];
+		}
+
+		void EncodeChannelBlock(const uint32_t* pTexels, int shift, uint8_t* pBlock)
+		{
+			uint8_t minValue{ 255 }, maxValue{};
+			for (int i{}; i < g_TexelsPerBlock; ++i)
+			{
+				minValue = std::min(minValue, Channel(pTexels[i], shift));
+				maxValue = std::max(maxValue, Channel(pTexels[i], shift));
+			}
+
+			uint8_t palette[8]{};
+			ChannelPalette(maxValue, minValue, palette);
+
+			uint64_t indices{};
+			if (maxValue != minValue)
+			{
+				for (int i{}; i < g_TexelsPerBlock; ++i)
+				{
+					uint64_t bestIndex{};
+					int bestDistance{ INT32_MAX };
+					for (uint64_t entry{}; entry < 8; ++entry)
+					{
+						const int distance{ std::abs(int(Channel(pTexels[i], shift)) - int(palette[entry])) };
+						if (distance < bestDistance)
+						{
+							bestDistance = distance;
+							bestIndex = entry;
+						}
+					}
+					indices |= bestIndex << (i * 3);
+				}
+			}
+
+			pBlock[0] = maxValue;
+			pBlock[1] = minValue;
+			//48 bits of 3 bit indices, little endian
+			for (int byte{}; byte < 6; ++byte)
+				pBlock[2 + byte] = uint8_t(indices >> (byte * 8));
+		}
+
+		void DecodeChannelBlock(const uint8_t* pBlock, uint8_t* pValues)
+		{
+			uint8_t palette[8]{};
+			ChannelPalette(pBlock[0], pBlock[1], palette);
+
+			uint64_t indices{};
+			for (int byte{}; byte < 6; ++byte)
+				indices |= uint64_t(pBlock[2 + byte]) << (byte * 8);
+
+			for (int i{}; i < g_TexelsPerBlock; ++i)
+				pValues[i] = palette[(indices >> (i * 3)) & 0x7];
+		}
+	}
+
+	size_t BlockCompression::GetBlockSize(TextureFormat format)
+	{
+		switch (format)
+		{
+		case TextureFormat::BC1:
+			return 8;
+		case TextureFormat::BC3:
+		case TextureFormat::BC5:
+			return 16;
+		default:
+			return 0;
+		}
+	}
+
+	void BlockCompression::EncodeBlock(TextureFormat format, const uint32_t* pTexels, uint8_t* pBlock)
+	{
+		switch (format)
+		{
+		case TextureFormat::BC1:
+			EncodeColorBlock(pTexels, pBlock);
+			break;
+		case TextureFormat::BC3:
+			EncodeChannelBlock(pTexels, 24, pBlock);
+			EncodeColorBlock(pTexels, pBlock + 8);
+			break;
+		case TextureFormat::BC5:
+			EncodeChannelBlock(pTexels, 0, pBlock);
+			EncodeChannelBlock(pTexels, 8, pBlock + 8);
+			break;
+		default:
+			break;
+		}
+	}
+
+	void BlockCompression::DecodeBlock(TextureFormat format, const uint8_t* pBlock, uint32_t* pTexels)
+	{
+		switch (format)
+		{
+		case TextureFormat::BC1:
+			DecodeColorBlock(pBlock, true, pTexels);
+			break;
+		case TextureFormat::BC3:
+		{
+			uint8_t alpha[g_TexelsPerBlock]{};
+			DecodeChannelBlock(pBlock, alpha);
+			DecodeColorBlock(pBlock + 8, false, pTexels);
+			for (int i{}; i < g_TexelsPerBlock; ++i)
+				pTexels[i] = (pTexels[i] & 0x00FFFFFF) | (uint32_t(alpha[i]) << 24);
+			break;
+		}
+		case TextureFormat::BC5:
+		{
+			uint8_t x[g_TexelsPerBlock]{}, y[g_TexelsPerBlock]{};
+			DecodeChannelBlock(pBlock, x);
+			DecodeChannelBlock(pBlock + 8, y);
+			for (int i{}; i < g_TexelsPerBlock; ++i)
+			{
+				//Unit normal, so z follows from x and y
+				const float normalX{ float(x[i]) / 127.5f - 1.f };
+				const float normalY{ float(y[i]) / 127.5f - 1.f };
+				const float normalZ{ std::sqrt(std::max(1.f - normalX * normalX - normalY * normalY, 0.f)) };
+				pTexels[i] = Pack(x[i], y[i], uint32_t((normalZ * .5f + .5f) * 255.f + .5f), 255);
+			}
+			break;
+		}
+		default:
+			break;
+		}
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace dae
+{
+	//Storage format of texture data, the BC formats store 4x4 texel blocks
+	enum class TextureFormat
+	{
+		RGBA8,
+		BC1,	//RGB, 8 bytes per block
+		BC3,	//RGBA, 16 bytes per block
+		BC5		//Two channels (normal map XY), 16 bytes per block, Z is reconstructed on decode
+	};
+
+	namespace BlockCompression
+	{
+		//Bytes per 4x4 block, 0 for uncompressed formats
+		size_t GetBlockSize(TextureFormat format);
+
+		//pTexels holds the 16 RGBA8 texels of a block row by row, red in the lowest byte
+		void EncodeBlock(TextureFormat format, const uint32_t* pTexels, uint8_t* pBlock);
+		void DecodeBlock(TextureFormat format, const uint8_t* pBlock, uint32_t* pTexels);
+	}
+}
@@ -0,0 +1,54 @@
+#include "CameraPath.h"
+#include "Camera.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace dae
+{
+	bool CameraPath::LoadFromFile(const std::string& path)
+	{
+		std::ifstream file{ path };
+		if (!file)
+		{
+			std::cerr << "Could not open camera path " << path << '\n';
+			return false;
+		}
+
+		m_Keyframes.clear();
+
+		std::string line{};
+		for (int lineNumber{ 1 }; std::getline(file, line); ++lineNumber)
+		{
+			const size_t first{ line.find_first_not_of(" \t\r") };
+			if (first == std::string::npos || line[first] == '#')
+				continue;
+
+			CameraKeyframe keyframe{};
+			std::istringstream stream{ line };
+			stream >> keyframe.origin.x >> keyframe.origin.y >> keyframe.origin.z
+				>> keyframe.forward.x >> keyframe.forward.y >> keyframe.forward.z
+				>> keyframe.fovAngle;
+
+			if (stream.fail() || keyframe.forward.SqrMagnitude() <= 0.f)
+			{
+				std::cerr << path << '(' << lineNumber << "): expected origin xyz, forward xyz and fov: " << line << '\n';
+				return false;
+			}
+
+			keyframe.forward.Normalize();
+			m_Keyframes.emplace_back(keyframe);
+		}
+
+		return true;
+	}
+
+	void CameraPath::Apply(size_t frame, Camera& camera) const
+	{
+		const CameraKeyframe& keyframe{ m_Keyframes[frame] };
+		camera.Initialize(keyframe.fovAngle, keyframe.origin);
+		camera.forward = keyframe.forward;
+		camera.CalculateViewMatrix();
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "Vector3.h"
+
+namespace dae
+{
+	struct Camera;
+
+	struct CameraKeyframe
+	{
+		Vector3 origin{};
+		Vector3 forward{ 0.f, 0.f, 1.f };
+		float fovAngle{ 60.f };
+	};
+
+	//One keyframe per line: origin xyz, forward xyz, fov angle in degrees
+	//Empty lines and lines starting with # are skipped
+	class CameraPath final
+	{
+	public:
+		//Returns false and prints the offending line when the file can't be read
+		bool LoadFromFile(const std::string& path);
+
+		size_t GetFrameCount() const { return m_Keyframes.size(); }
+		const CameraKeyframe& GetKeyframe(size_t frame) const { return m_Keyframes[frame]; }
+
+		void Apply(size_t frame, Camera& camera) const;
+
+	private:
+		std::vector<CameraKeyframe> m_Keyframes{};
+	};
+}
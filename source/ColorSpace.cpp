@@ -0,0 +1,65 @@
+#include "ColorSpace.h"
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+namespace dae
+{
+	namespace ColorSpace
+	{
+		//Exact sRGB transfer functions, only used to build the tables
+		namespace
+		{
+			float DecodeExact(float value)
+			{
+				return value <= .04045f ? value / 12.92f : std::pow((value + .055f) / 1.055f, 2.4f);
+			}
+
+			float EncodeExact(float value)
+			{
+				return value <= .0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - .055f;
+			}
+		}
+
+		const std::array<float, 256> g_SRGBToLinear{ []()
+		{
+			std::array<float, 256> lut{};
+			for (size_t i{}; i < lut.size(); ++i)
+				lut[i] = DecodeExact(float(i) / 255.f);
+			return lut;
+		}() };
+
+		const std::array<uint8_t, 4096> g_LinearToSRGB{ []()
+		{
+			std::array<uint8_t, 4096> lut{};
+			for (size_t i{}; i < lut.size(); ++i)
+				lut[i] = uint8_t(EncodeExact(float(i) / float(lut.size() - 1)) * 255.f + .5f);
+			return lut;
+		}() };
+
+		void LinearToSRGB(const float* pLinear, uint8_t* pEncoded, size_t count)
+		{
+			const __m128 zero{ _mm_setzero_ps() };
+			const __m128 maxIndex{ _mm_set1_ps(float(g_LinearToSRGB.size() - 1)) };
+			const __m128 half{ _mm_set1_ps(.5f) };
+
+			size_t i{};
+			for (; i + 4 <= count; i += 4)
+			{
+				//Clamping before the scale also maps NaN to 0
+				const __m128 linear{ _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pLinear + i), zero), _mm_set1_ps(1.f)) };
+
+				alignas(16) int32_t indices[4];
+				_mm_store_si128(reinterpret_cast<__m128i*>(indices), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(linear, maxIndex), half)));
+
+				pEncoded[i] = g_LinearToSRGB[indices[0]];
+				pEncoded[i + 1] = g_LinearToSRGB[indices[1]];
+				pEncoded[i + 2] = g_LinearToSRGB[indices[2]];
+				pEncoded[i + 3] = g_LinearToSRGB[indices[3]];
+			}
+
+			for (; i < count; ++i)
+				pEncoded[i] = LinearToSRGB(pLinear[i]);
+		}
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace dae
+{
+	//Conversions between linear values, in which shading and filtering happen, and sRGB encoded bytes
+	namespace ColorSpace
+	{
+		//sRGB byte to linear [0, 1]
+		extern const std::array<float, 256> g_SRGBToLinear;
+		//Linear [0, 1] quantized to 12 bits, to the nearest sRGB byte
+		extern const std::array<uint8_t, 4096> g_LinearToSRGB;
+
+		inline float SRGBToLinear(uint8_t value)
+		{
+			return g_SRGBToLinear[value];
+		}
+
+		//Values outside [0, 1] are clamped
+		inline uint8_t LinearToSRGB(float value)
+		{
+			const float index{ value * float(g_LinearToSRGB.size() - 1) + .5f };
+			return g_LinearToSRGB[index > 0.f ? std::min(size_t(index), g_LinearToSRGB.size() - 1) : 0];
+		}
+
+		//Encodes count values, clamping and quantizing four at a time with SSE
+		void LinearToSRGB(const float* pLinear, uint8_t* pEncoded, size_t count);
+	}
+}
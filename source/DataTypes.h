@@ -1,5 +1,6 @@
 #pragma once
 #include "Math.h"
+#include <cstdint>
 #include "vector"
 
 namespace dae
@@ -13,16 +14,33 @@ namespace dae
 		//Vector3 tangent{}; //W4
 		//Vector3 viewDirection{}; //W4
 	};
+	static_assert(sizeof(Vertex) == 32);
 
-	struct Vertex_Out
+	//Hot stream, all that vertex transform and triangle setup read, one SSE load per vertex
+	struct alignas(16) VertexPosition
+	{
+		Vector3 position{};
+	};
+	static_assert(sizeof(VertexPosition) == 16);
+
+	//Cold stream, only read for triangles that cover pixels, 32 bytes once normal and tangent are in
+	struct VertexAttributes
+	{
+		Vector2 uv{};
+		//Vector3 normal{}; //W4
+		//Vector3 tangent{}; //W4
+	};
+
+	//Textured paths don't interpolate a color, position and uv fill exactly 32 bytes
+	struct alignas(16) Vertex_Out
 	{
 		Vector4 position{};
-		ColorRGB color{ colors::White };
-		//Vector2 uv{};
+		Vector2 uv{};
 		//Vector3 normal{};
 		//Vector3 tangent{};
 		//Vector3 viewDirection{};
 	};
+	static_assert(sizeof(Vertex_Out) == 32);
 
 	enum class PrimitiveTopology
 	{
@@ -30,13 +48,33 @@ namespace dae
 		TriangleStrip
 	};
 
+	//In a strip's indices, ends the current strip, the next index starts a new one
+	constexpr uint32_t PrimitiveRestartIndex{ 0xFFFFFFFF };
+
 	struct Mesh
 	{
 		std::vector<Vertex> vertices{};
 		std::vector<uint32_t> indices{};
 		PrimitiveTopology primitiveTopology{ PrimitiveTopology::TriangleStrip };
+		//indices as a triangle list, whatever the topology, see AssembleTriangles
+		std::vector<uint32_t> triangleIndices{};
 
 		std::vector<Vertex_Out> vertices_out{};
 		Matrix worldMatrix{};
+
+		//vertices split in a position and an attribute stream, so transform and setup only touch the bytes they use
+		std::vector<VertexPosition> positions{};
+		std::vector<VertexAttributes> attributes{};
+
+		void SplitStreams()
+		{
+			positions.resize(vertices.size());
+			attributes.resize(vertices.size());
+			for (size_t i{}; i < vertices.size(); ++i)
+			{
+				positions[i].position = vertices[i].position;
+				attributes[i].uv = vertices[i].uv;
+			}
+		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "DepthBuffer.h"
+#include "MathHelpers.h"
+#include "StreamFill.h"
+#include <algorithm>
+#include <cstring>
+
+namespace dae
+{
+	DepthBuffer::DepthBuffer(int width, int height, DepthFormat format, bool isReversed, float nearPlane, float farPlane) :
+		m_PixelCount{ size_t(width) * height },
+		m_BytesPerPixel{ format == DepthFormat::Float32 ? size_t(4) : format == DepthFormat::Unorm24 ? size_t(3) : size_t(2) },
+		m_Format{ format },
+		m_IsReversed{ isReversed }
+	{
+		//Third row of a left handed perspective matrix: z' = far / (far - near) - far * near / ((far - near) * z)
+		const float range{ farPlane - nearPlane };
+		m_Offset = farPlane / range;
+		m_Scale = -farPlane * nearPlane / range;
+		if (m_IsReversed)
+		{
+			m_Offset = 1.f - m_Offset;
+			m_Scale = -m_Scale;
+		}
+
+		m_pData = new uint8_t[GetSize()]{};
+		m_ClearValue = Encode(farPlane);
+		Clear(0, m_PixelCount);
+		_mm_sfence();
+	}
+
+	DepthBuffer::~DepthBuffer()
+	{
+		delete[] m_pData;
+	}
+
+	float DepthBuffer::Normalize(float viewDepth) const
+	{
+		return Saturate(m_Offset + m_Scale / viewDepth);
+	}
+
+	uint32_t DepthBuffer::Encode(float viewDepth) const
+	{
+		const float depth{ Normalize(viewDepth) };
+		switch (m_Format)
+		{
+		//Rounding 1 up in float can step past the largest value
+		case DepthFormat::Unorm24:
+			return std::min(uint32_t(depth * float(0xFFFFFF) + .5f), 0xFFFFFFu);
+		case DepthFormat::Unorm16:
+			return std::min(uint32_t(depth * float(0xFFFF) + .5f), 0xFFFFu);
+		default:
+		{
+			//Non negative floats order the same as their bits
+			uint32_t bits{};
+			std::memcpy(&bits, &depth, sizeof(bits));
+			return bits;
+		}
+		}
+	}
+
+	bool DepthBuffer::TestAndWrite(size_t index, float viewDepth)
+	{
+		const uint32_t value{ Encode(viewDepth) };
+		const uint32_t stored{ Load(index) };
+		if (m_IsReversed ? value <= stored : value >= stored)
+			return false;
+
+		Store(index, value);
+		return true;
+	}
+
+	void DepthBuffer::Clear(size_t index, size_t count)
+	{
+		switch (m_Format)
+		{
+		case DepthFormat::Float32:
+			StreamFill(reinterpret_cast<uint32_t*>(m_pData) + index, count, m_ClearValue);
+			break;
+		case DepthFormat::Unorm16:
+			StreamFill(reinterpret_cast<uint16_t*>(m_pData) + index, count, uint16_t(m_ClearValue));
+			break;
+		default:
+			for (size_t i{ index }; i < index + count; ++i)
+				Store(i, m_ClearValue);
+			break;
+		}
+	}
+
+	uint32_t DepthBuffer::Load(size_t index) const
+	{
+		//Little endian, only the pixel's own bytes, the next pixel can belong to a tile another worker writes
+		uint32_t value{};
+		std::memcpy(&value, m_pData + index * m_BytesPerPixel, m_BytesPerPixel);
+		return value;
+	}
+
+	void DepthBuffer::Store(size_t index, uint32_t value)
+	{
+		std::memcpy(m_pData + index * m_BytesPerPixel, &value, m_BytesPerPixel);
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace dae
+{
+	enum class DepthFormat
+	{
+		Float32,
+		Unorm24, //Three bytes per pixel
+		Unorm16
+	};
+
+	//Stores depth normalized between the near and far plane, the way a perspective projection maps it
+	//Reversed depth puts the far plane at 0, which spreads float32 precision evenly over the range
+	class DepthBuffer final
+	{
+	public:
+		DepthBuffer(int width, int height, DepthFormat format, bool isReversed, float nearPlane, float farPlane);
+		~DepthBuffer();
+
+		DepthBuffer(const DepthBuffer&) = delete;
+		DepthBuffer(DepthBuffer&&) noexcept = delete;
+		DepthBuffer& operator=(const DepthBuffer&) = delete;
+		DepthBuffer& operator=(DepthBuffer&&) noexcept = delete;
+
+		DepthFormat GetFormat() const { return m_Format; }
+		bool IsReversed() const { return m_IsReversed; }
+		size_t GetBytesPerPixel() const { return m_BytesPerPixel; }
+		size_t GetSize() const { return m_BytesPerPixel * m_PixelCount; }
+
+		//View space depth to [0, 1], depth outside the planes is clamped onto them
+		float Normalize(float viewDepth) const;
+		//Stored value of a view space depth, nearer is smaller unless reversed
+		uint32_t Encode(float viewDepth) const;
+
+		//Writes the depth and returns true when it is nearer than the stored one
+		bool TestAndWrite(size_t index, float viewDepth);
+
+		//Sets count pixels from index on to the far plane
+		void Clear(size_t index, size_t count);
+
+	private:
+		uint32_t Load(size_t index) const;
+		void Store(size_t index, uint32_t value);
+
+		uint8_t* m_pData{ nullptr };
+		size_t m_PixelCount{};
+		size_t m_BytesPerPixel{};
+		DepthFormat m_Format{ DepthFormat::Float32 };
+		bool m_IsReversed{ false };
+
+		//Normalized depth is linear in 1 / view depth: offset + scale / viewDepth
+		float m_Offset{};
+		float m_Scale{};
+		uint32_t m_ClearValue{};
+	};
+}
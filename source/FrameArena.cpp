@@ -0,0 +1,82 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cassert>
+
+namespace dae
+{
+	namespace
+	{
+		constexpr std::align_val_t g_BlockAlignment{ 64 };
+	}
+
+	FrameArena::FrameArena(uint32_t threadCount, size_t blockSize) :
+		m_SubArenas(threadCount),
+		m_BlockSize{ blockSize }
+	{
+		for (SubArena& subArena : m_SubArenas)
+			AddBlock(subArena, m_BlockSize);
+
+		//The first blocks are the planned capacity, only the ones a frame adds are counted
+		m_BlockAllocationCount.store(0, std::memory_order_relaxed);
+	}
+
+	FrameArena::~FrameArena()
+	{
+		for (SubArena& subArena : m_SubArenas)
+		{
+			for (const Block& block : subArena.blocks)
+				::operator delete(block.pData, g_BlockAlignment);
+		}
+	}
+
+	void* FrameArena::Allocate(uint32_t threadIndex, size_t size, size_t alignment)
+	{
+		assert(alignment <= size_t(g_BlockAlignment) && "Blocks are only aligned to a cache line");
+
+		SubArena& subArena{ m_SubArenas[threadIndex] };
+		while (true)
+		{
+			if (subArena.blockIndex == subArena.blocks.size())
+				AddBlock(subArena, size);
+
+			const Block& block{ subArena.blocks[subArena.blockIndex] };
+			const size_t start{ (subArena.offset + alignment - 1) & ~(alignment - 1) };
+			if (start + size <= block.size)
+			{
+				subArena.offset = start + size;
+				return block.pData + start;
+			}
+
+			//The rest of this block stays unused until Reset
+			++subArena.blockIndex;
+			subArena.offset = 0;
+		}
+	}
+
+	void FrameArena::Reset()
+	{
+		for (SubArena& subArena : m_SubArenas)
+		{
+			subArena.blockIndex = 0;
+			subArena.offset = 0;
+		}
+	}
+
+	size_t FrameArena::GetCapacity() const
+	{
+		size_t capacity{};
+		for (const SubArena& subArena : m_SubArenas)
+		{
+			for (const Block& block : subArena.blocks)
+				capacity += block.size;
+		}
+		return capacity;
+	}
+
+	void FrameArena::AddBlock(SubArena& subArena, size_t minimumSize)
+	{
+		const size_t size{ std::max(m_BlockSize, minimumSize) };
+		subArena.blocks.push_back(Block{ static_cast<std::byte*>(::operator new(size, g_BlockAlignment)), size });
+		m_BlockAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
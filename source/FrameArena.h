@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace dae
+{
+	//Bump allocator for data that lives one frame, Reset frees all of it at once and keeps the memory
+	//Every thread allocates from a sub-arena of its own, so allocating takes neither atomics nor locks
+	class FrameArena final
+	{
+	public:
+		//blockSize bytes per sub-arena to start with, a frame that needs more adds blocks that are kept from then on
+		FrameArena(uint32_t threadCount, size_t blockSize);
+		~FrameArena();
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena(FrameArena&&) noexcept = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+		FrameArena& operator=(FrameArena&&) noexcept = delete;
+
+		//Only the thread that owns the index allocates from it, alignment at most 64
+		void* Allocate(uint32_t threadIndex, size_t size, size_t alignment);
+
+		//count value initialized elements, nothing is destroyed on Reset
+		template<typename Type>
+		Type* Allocate(uint32_t threadIndex, size_t count)
+		{
+			static_assert(std::is_trivially_destructible_v<Type>, "Reset frees without calling destructors");
+
+			Type* pData{ static_cast<Type*>(Allocate(threadIndex, sizeof(Type) * count, alignof(Type))) };
+			for (size_t i{}; i < count; ++i)
+				new (pData + i) Type{};
+			return pData;
+		}
+
+		//Rewinds every sub-arena, no thread may be allocating
+		void Reset();
+
+		//Blocks added because a frame outgrew its sub-arena, stays constant once frames are steady
+		uint64_t GetBlockAllocationCount() const { return m_BlockAllocationCount.load(std::memory_order_relaxed); }
+		size_t GetCapacity() const;
+
+	private:
+		struct Block
+		{
+			std::byte* pData{};
+			size_t size{};
+		};
+
+		//Own cache line each, the bump offsets of different threads never share one
+		struct alignas(64) SubArena
+		{
+			std::vector<Block> blocks{};
+			size_t blockIndex{};
+			size_t offset{};
+		};
+
+		void AddBlock(SubArena& subArena, size_t minimumSize);
+
+		std::vector<SubArena> m_SubArenas{};
+		size_t m_BlockSize{};
+		std::atomic<uint64_t> m_BlockAllocationCount{};
+	};
+}
@@ -0,0 +1,101 @@
+#include "FrameClearer.h"
+#include "DepthBuffer.h"
+#include "JobSystem.h"
+#include "StreamFill.h"
+#include <algorithm>
+
+namespace dae
+{
+	FrameClearer::FrameClearer(uint32_t* pColorBuffer, DepthBuffer* pDepthBuffer, int width, int height, JobSystem* pJobSystem, int tileSize) :
+		m_pColorBuffer{ pColorBuffer },
+		m_pDepthBuffer{ pDepthBuffer },
+		m_pJobSystem{ pJobSystem },
+		m_Width{ width },
+		m_Height{ height },
+		m_TileSize{ tileSize },
+		m_TilesPerRow{ (width + tileSize - 1) / tileSize }
+	{
+		//Nothing is known about the buffers yet
+		m_DirtyTiles.assign(size_t(m_TilesPerRow) * ((height + tileSize - 1) / tileSize), 1);
+	}
+
+	void FrameClearer::MarkDirty(int minX, int minY, int maxX, int maxY)
+	{
+		for (int tileY{ minY / m_TileSize }; tileY <= maxY / m_TileSize; ++tileY)
+		{
+			for (int tileX{ minX / m_TileSize }; tileX <= maxX / m_TileSize; ++tileX)
+				m_DirtyTiles[size_t(tileY) * m_TilesPerRow + tileX] = 1;
+		}
+	}
+
+	void FrameClearer::MarkAllDirty()
+	{
+		std::fill(m_DirtyTiles.begin(), m_DirtyTiles.end(), uint8_t(1));
+	}
+
+	void FrameClearer::Clear(uint32_t color)
+	{
+		//Clean tiles hold the previous clear color
+		if (color != m_LastColor)
+		{
+			MarkAllDirty();
+			m_LastColor = color;
+		}
+
+		m_TilesToClear.clear();
+		for (int tileIndex{}; tileIndex < GetTileCount(); ++tileIndex)
+		{
+			if (!m_DirtyTiles[tileIndex])
+				continue;
+
+			m_TilesToClear.push_back(tileIndex);
+			m_DirtyTiles[tileIndex] = 0;
+		}
+
+		ClearTiles(m_TilesToClear, color);
+	}
+
+	void FrameClearer::ClearAll(uint32_t color)
+	{
+		m_TilesToClear.resize(GetTileCount());
+		for (int tileIndex{}; tileIndex < GetTileCount(); ++tileIndex)
+			m_TilesToClear[tileIndex] = tileIndex;
+
+		ClearTiles(m_TilesToClear, color);
+		MarkAllDirty();
+	}
+
+	void FrameClearer::ClearTiles(const std::vector<int>& tileIndices, uint32_t color) const
+	{
+		const auto clearRange = [&](size_t first, size_t last)
+		{
+			for (size_t i{ first }; i < last; ++i)
+				ClearTile(tileIndices[i], color);
+
+			//Streaming stores are weakly ordered, make them visible before anything reads the buffers
+			//Each thread has to fence its own, finishing the job does not
+			_mm_sfence();
+		};
+
+		//Several tiles per job, so scheduling stays small next to the stores
+		if (m_pJobSystem)
+			m_pJobSystem->ParallelFor(0, tileIndices.size(), 4, clearRange);
+		else
+			clearRange(0, tileIndices.size());
+	}
+
+	void FrameClearer::ClearTile(int tileIndex, uint32_t color) const
+	{
+		const int minX{ (tileIndex % m_TilesPerRow) * m_TileSize };
+		const int minY{ (tileIndex / m_TilesPerRow) * m_TileSize };
+		const size_t rowLength{ size_t(std::min(m_TileSize, m_Width - minX)) };
+		const int maxY{ std::min(minY + m_TileSize, m_Height) };
+
+		for (int y{ minY }; y < maxY; ++y)
+		{
+			const size_t rowStart{ size_t(y) * m_Width + minX };
+			StreamFill(m_pColorBuffer + rowStart, rowLength, color);
+			m_pDepthBuffer->Clear(rowStart, rowLength);
+		}
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace dae
+{
+	class DepthBuffer;
+	class JobSystem;
+
+	//Clears a color buffer to a color and a depth buffer to its far plane, tile by tile with streaming stores
+	//Tiles nothing was drawn to since their last clear are skipped
+	class FrameClearer final
+	{
+	public:
+		FrameClearer() = default;
+		//Without a job system every tile is cleared on the calling thread
+		FrameClearer(uint32_t* pColorBuffer, DepthBuffer* pDepthBuffer, int width, int height, JobSystem* pJobSystem = nullptr, int tileSize = 64);
+
+		int GetTileCount() const { return int(m_DirtyTiles.size()); }
+		int GetTileSize() const { return m_TileSize; }
+
+		//Inclusive pixel bounds, already clamped to the buffers
+		void MarkDirty(int minX, int minY, int maxX, int maxY);
+		void MarkAllDirty();
+
+		//Clears the dirty tiles and marks them clean, a new clear color dirties every tile
+		void Clear(uint32_t color);
+		//For passes that don't mark what they draw, every tile stays dirty
+		void ClearAll(uint32_t color);
+
+		//One tile, regardless of its flag, so tiles can be cleared in parallel
+		void ClearTile(int tileIndex, uint32_t color) const;
+
+	private:
+		void ClearTiles(const std::vector<int>& tileIndices, uint32_t color) const;
+
+		uint32_t* m_pColorBuffer{ nullptr };
+		DepthBuffer* m_pDepthBuffer{ nullptr };
+		JobSystem* m_pJobSystem{ nullptr };
+		int m_Width{};
+		int m_Height{};
+		int m_TileSize{};
+		int m_TilesPerRow{};
+
+		std::vector<uint8_t> m_DirtyTiles{};
+		std::vector<int> m_TilesToClear{};
+		uint32_t m_LastColor{};
+	};
+}
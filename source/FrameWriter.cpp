@@ -0,0 +1,157 @@
+#include "FrameWriter.h"
+
+//External includes
+#include <SDL_image.h>
+#include <SDL_surface.h>
+
+//Standard includes
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace dae
+{
+	FrameWriter::FrameWriter(int width, int height, const SDL_PixelFormat* pFormat, ImageFormat imageFormat, uint32_t bufferCount, uint32_t threadCount) :
+		m_Width{ width },
+		m_Height{ height },
+		m_ImageFormat{ imageFormat },
+		m_PixelFormat{ pFormat->format },
+		m_RedShift{ pFormat->Rshift },
+		m_GreenShift{ pFormat->Gshift },
+		m_BlueShift{ pFormat->Bshift }
+	{
+		bufferCount = std::max(bufferCount, 1u);
+		m_Buffers.resize(bufferCount, std::vector<uint32_t>(size_t(width) * height));
+		for (size_t i{}; i < bufferCount; ++i)
+			m_FreeBuffers.push_back(i);
+
+		for (uint32_t i{}; i < std::max(threadCount, 1u); ++i)
+			m_Workers.emplace_back(&FrameWriter::WorkerLoop, this);
+	}
+
+	FrameWriter::~FrameWriter()
+	{
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_IsStopping = true;
+		}
+		m_FrameAdded.notify_all();
+
+		//Workers drain the queue before they stop
+		for (std::thread& worker : m_Workers)
+			worker.join();
+	}
+
+	void FrameWriter::Submit(const uint32_t* pPixels, const std::string& path)
+	{
+		std::unique_lock lock{ m_Mutex };
+		m_BufferFreed.wait(lock, [this]() { return !m_FreeBuffers.empty(); });
+
+		const size_t bufferIndex{ m_FreeBuffers.back() };
+		m_FreeBuffers.pop_back();
+
+		//No one else touches a buffer between taking it from the free list and queueing it
+		lock.unlock();
+		std::memcpy(m_Buffers[bufferIndex].data(), pPixels, m_Buffers[bufferIndex].size() * sizeof(uint32_t));
+		lock.lock();
+
+		m_Frames.push_back(Frame{ bufferIndex, path });
+		++m_ActiveFrames;
+		lock.unlock();
+		m_FrameAdded.notify_one();
+	}
+
+	void FrameWriter::WaitIdle()
+	{
+		std::unique_lock lock{ m_Mutex };
+		m_BufferFreed.wait(lock, [this]() { return m_ActiveFrames == 0; });
+	}
+
+	uint32_t FrameWriter::GetFailedCount()
+	{
+		std::lock_guard lock{ m_Mutex };
+		return m_FailedCount;
+	}
+
+	const char* FrameWriter::GetExtension(ImageFormat format)
+	{
+		switch (format)
+		{
+		case ImageFormat::PPM:
+			return "ppm";
+		case ImageFormat::PNG:
+			return "png";
+		default:
+			return "bmp";
+		}
+	}
+
+	void FrameWriter::WorkerLoop()
+	{
+		while (true)
+		{
+			Frame frame{};
+			{
+				std::unique_lock lock{ m_Mutex };
+				m_FrameAdded.wait(lock, [this]() { return m_IsStopping || !m_Frames.empty(); });
+				if (m_Frames.empty())
+					return;
+
+				frame = std::move(m_Frames.front());
+				m_Frames.pop_front();
+			}
+
+			const bool isWritten{ Encode(m_Buffers[frame.bufferIndex], frame.path) };
+
+			{
+				std::lock_guard lock{ m_Mutex };
+				m_FreeBuffers.push_back(frame.bufferIndex);
+				--m_ActiveFrames;
+				if (!isWritten)
+					++m_FailedCount;
+			}
+			//Submit waits for a buffer, WaitIdle for the count, both share the condition
+			m_BufferFreed.notify_all();
+		}
+	}
+
+	bool FrameWriter::Encode(const std::vector<uint32_t>& pixels, const std::string& path) const
+	{
+		if (m_ImageFormat == ImageFormat::PPM)
+			return WritePPM(pixels, path);
+
+		//The surface only borrows the pixels, SDL converts while saving
+		SDL_Surface* pSurface{ SDL_CreateRGBSurfaceWithFormatFrom(const_cast<uint32_t*>(pixels.data()), m_Width, m_Height, 32,
+			m_Width * int(sizeof(uint32_t)), m_PixelFormat) };
+		if (!pSurface)
+			return false;
+
+		const int result{ m_ImageFormat == ImageFormat::PNG ? IMG_SavePNG(pSurface, path.c_str()) : SDL_SaveBMP(pSurface, path.c_str()) };
+		SDL_FreeSurface(pSurface);
+		return result == 0;
+	}
+
+	bool FrameWriter::WritePPM(const std::vector<uint32_t>& pixels, const std::string& path) const
+	{
+		std::ofstream file{ path, std::ios::binary };
+		if (!file)
+			return false;
+
+		file << "P6\n" << m_Width << ' ' << m_Height << "\n255\n";
+
+		std::vector<uint8_t> row(size_t(m_Width) * 3);
+		for (int y{}; y < m_Height; ++y)
+		{
+			const uint32_t* pRow{ pixels.data() + size_t(y) * m_Width };
+			for (int x{}; x < m_Width; ++x)
+			{
+				row[x * 3] = uint8_t(pRow[x] >> m_RedShift);
+				row[x * 3 + 1] = uint8_t(pRow[x] >> m_GreenShift);
+				row[x * 3 + 2] = uint8_t(pRow[x] >> m_BlueShift);
+			}
+			file.write(reinterpret_cast<const char*>(row.data()), std::streamsize(row.size()));
+		}
+
+		return bool(file);
+	}
+}
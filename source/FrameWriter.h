@@ -0,0 +1,76 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct SDL_PixelFormat;
+
+namespace dae
+{
+	enum class ImageFormat
+	{
+		BMP,
+		PPM, //Binary P6, written without SDL
+		PNG
+	};
+
+	//Writes frames on encoder threads, the render thread only copies the pixels into a free buffer
+	class FrameWriter final
+	{
+	public:
+		//bufferCount frames can wait for encoding, 2 double buffers the color buffer
+		FrameWriter(int width, int height, const SDL_PixelFormat* pFormat, ImageFormat imageFormat, uint32_t bufferCount = 2, uint32_t threadCount = 1);
+		//Writes every submitted frame before returning
+		~FrameWriter();
+
+		FrameWriter(const FrameWriter&) = delete;
+		FrameWriter(FrameWriter&&) noexcept = delete;
+		FrameWriter& operator=(const FrameWriter&) = delete;
+		FrameWriter& operator=(FrameWriter&&) noexcept = delete;
+
+		//Copies width * height packed pixels, blocks only while every buffer is still waiting to be encoded
+		void Submit(const uint32_t* pPixels, const std::string& path);
+
+		//Blocks until every submitted frame is written
+		void WaitIdle();
+		uint32_t GetFailedCount();
+
+		//"bmp", "ppm" or "png", also used as the file extension
+		static const char* GetExtension(ImageFormat format);
+
+	private:
+		struct Frame
+		{
+			size_t bufferIndex{};
+			std::string path{};
+		};
+
+		void WorkerLoop();
+		bool Encode(const std::vector<uint32_t>& pixels, const std::string& path) const;
+		bool WritePPM(const std::vector<uint32_t>& pixels, const std::string& path) const;
+
+		int m_Width{};
+		int m_Height{};
+		ImageFormat m_ImageFormat{ ImageFormat::BMP };
+		uint32_t m_PixelFormat{};
+		uint32_t m_RedShift{};
+		uint32_t m_GreenShift{};
+		uint32_t m_BlueShift{};
+
+		std::vector<std::vector<uint32_t>> m_Buffers{};
+		std::vector<size_t> m_FreeBuffers{};
+		std::deque<Frame> m_Frames{};
+
+		std::vector<std::thread> m_Workers{};
+		std::mutex m_Mutex{};
+		std::condition_variable m_FrameAdded{};
+		std::condition_variable m_BufferFreed{};
+		uint32_t m_ActiveFrames{};
+		uint32_t m_FailedCount{};
+		bool m_IsStopping{ false };
+	};
+}
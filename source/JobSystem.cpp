@@ -0,0 +1,315 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <cassert>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace dae
+{
+	namespace
+	{
+		//Lets a job that submits or waits find the queue of the worker it runs on
+		thread_local const JobSystem* t_pJobSystem{ nullptr };
+		thread_local uint32_t t_WorkerIndex{};
+		//Threads that are no worker but run jobs while they wait, with a thread index of their own
+		thread_local const JobSystem* t_pBoundJobSystem{ nullptr };
+		thread_local uint32_t t_BoundThreadIndex{};
+
+		void PinToCore(std::thread& thread, uint32_t workerIndex)
+		{
+#ifdef __linux__
+			//Cores outside the process' affinity, a container or taskset, would be refused
+			cpu_set_t allowedCores{};
+			if (sched_getaffinity(0, sizeof(allowedCores), &allowedCores) != 0)
+				return;
+
+			const int allowedCount{ CPU_COUNT(&allowedCores) };
+			if (allowedCount == 0)
+				return;
+
+			//The first allowed core is left to the thread that submits the frame
+			int remaining{ int((workerIndex + 1) % uint32_t(allowedCount)) };
+			for (int core{}; core < CPU_SETSIZE; ++core)
+			{
+				if (!CPU_ISSET(core, &allowedCores) || remaining-- > 0)
+					continue;
+
+				cpu_set_t workerCore{};
+				CPU_ZERO(&workerCore);
+				CPU_SET(core, &workerCore);
+				pthread_setaffinity_np(thread.native_handle(), sizeof(workerCore), &workerCore);
+				return;
+			}
+#else
+			(void)thread;
+			(void)workerIndex;
+#endif
+		}
+	}
+
+	JobSystem::JobSystem(uint32_t workerCount, bool isPinned, uint32_t boundThreadCount) :
+		m_BoundThreadCount{ boundThreadCount }
+	{
+		if (workerCount == 0)
+			workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+		m_Queues.reserve(workerCount);
+		for (uint32_t i{}; i < workerCount; ++i)
+		{
+			m_Queues.emplace_back(std::make_unique<WorkerQueue>());
+			m_Queues.back()->jobs.resize(64);
+		}
+
+		m_Workers.reserve(workerCount);
+		for (uint32_t i{}; i < workerCount; ++i)
+		{
+			m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+			if (isPinned)
+				PinToCore(m_Workers.back(), i);
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard lock{ m_SleepMutex };
+			m_IsStopping = true;
+		}
+		m_JobAdded.notify_all();
+
+		for (std::thread& worker : m_Workers)
+			worker.join();
+	}
+
+	uint32_t JobSystem::GetThreadIndex() const
+	{
+		if (t_pJobSystem == this)
+			return t_WorkerIndex + 1;
+		return t_pBoundJobSystem == this ? t_BoundThreadIndex : 0;
+	}
+
+	void JobSystem::BindThread(uint32_t slot)
+	{
+		assert(slot < m_BoundThreadCount);
+		t_pBoundJobSystem = this;
+		t_BoundThreadIndex = GetWorkerCount() + 1 + slot;
+	}
+
+	void JobSystem::Submit(std::function<void()> task, JobCounter& counter)
+	{
+		counter.m_PendingJobs.fetch_add(1, std::memory_order_relaxed);
+
+		Job job{};
+		job.task = std::move(task);
+		job.pCounter = &counter;
+		Push(std::move(job));
+		WakeWorkers(1);
+	}
+
+	void JobSystem::SubmitBackground(std::function<void()> task, JobCounter& counter)
+	{
+		counter.m_PendingJobs.fetch_add(1, std::memory_order_relaxed);
+
+		Job job{};
+		job.task = std::move(task);
+		job.pCounter = &counter;
+		{
+			std::lock_guard lock{ m_BackgroundQueue.mutex };
+			m_BackgroundQueue.PushBack(std::move(job));
+		}
+		m_QueuedJobs.fetch_add(1, std::memory_order_release);
+		WakeWorkers(1);
+	}
+
+	void JobSystem::Wait(const JobCounter& counter)
+	{
+		while (!counter.IsDone())
+		{
+			Job job{};
+			if (TryPop(job))
+				Execute(job);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	void JobSystem::RunParallelFor(size_t begin, size_t end, size_t grainSize, RangeFunction pRangeFunction, const void* pBody)
+	{
+		if (begin >= end)
+			return;
+
+		grainSize = std::max(grainSize, size_t(1));
+		const size_t jobCount{ (end - begin + grainSize - 1) / grainSize };
+		if (jobCount == 1)
+		{
+			pRangeFunction(pBody, begin, end);
+			return;
+		}
+
+		//The first chunk stays on this thread, the others go to the queues
+		JobCounter counter{};
+		counter.m_PendingJobs.store(uint32_t(jobCount - 1), std::memory_order_relaxed);
+		for (size_t first{ begin + grainSize }; first < end; first += grainSize)
+		{
+			Job job{};
+			job.pRangeFunction = pRangeFunction;
+			job.pRangeBody = pBody;
+			job.first = first;
+			job.last = std::min(first + grainSize, end);
+			job.pCounter = &counter;
+			Push(std::move(job));
+		}
+		WakeWorkers(uint32_t(jobCount - 1));
+
+		pRangeFunction(pBody, begin, std::min(begin + grainSize, end));
+		Wait(counter);
+	}
+
+	void JobSystem::WorkerLoop(uint32_t workerIndex)
+	{
+		t_pJobSystem = this;
+		t_WorkerIndex = workerIndex;
+
+		while (true)
+		{
+			//Only between jobs, a worker waiting inside a job keeps to frame work like any other waiting thread
+			Job job{};
+			if (TryPop(job) || TryPopBackground(job))
+			{
+				Execute(job);
+				continue;
+			}
+
+			std::unique_lock lock{ m_SleepMutex };
+			m_JobAdded.wait(lock, [this]() { return m_IsStopping || m_QueuedJobs.load(std::memory_order_acquire) > 0; });
+			if (m_IsStopping)
+				return;
+		}
+	}
+
+	void JobSystem::Push(Job&& job)
+	{
+		//Workers keep their own jobs, other threads spread theirs over all queues
+		const uint32_t queueIndex{ t_pJobSystem == this ? t_WorkerIndex
+			: m_NextQueue.fetch_add(1, std::memory_order_relaxed) % uint32_t(m_Queues.size()) };
+
+		WorkerQueue& queue{ *m_Queues[queueIndex] };
+		{
+			std::lock_guard lock{ queue.mutex };
+			queue.PushBack(std::move(job));
+		}
+		m_QueuedJobs.fetch_add(1, std::memory_order_release);
+	}
+
+	void JobSystem::WakeWorkers(uint32_t jobCount)
+	{
+		//Taking the lock orders this after a worker's check of m_QueuedJobs, so none misses the wake up
+		{
+			std::lock_guard lock{ m_SleepMutex };
+		}
+
+		if (jobCount == 1)
+			m_JobAdded.notify_one();
+		else
+			m_JobAdded.notify_all();
+	}
+
+	bool JobSystem::TryPop(Job& job)
+	{
+		const bool isWorker{ t_pJobSystem == this };
+		const uint32_t queueCount{ uint32_t(m_Queues.size()) };
+
+		//Newest first from the own queue, its data is most likely still in cache
+		if (isWorker)
+		{
+			WorkerQueue& queue{ *m_Queues[t_WorkerIndex] };
+			std::lock_guard lock{ queue.mutex };
+			if (queue.PopBack(job))
+			{
+				m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+
+		return TrySteal(isWorker ? t_WorkerIndex : queueCount - 1, job);
+	}
+
+	bool JobSystem::TrySteal(uint32_t thiefIndex, Job& job)
+	{
+		//Oldest first from the others, those are the biggest pieces of work left
+		const uint32_t queueCount{ uint32_t(m_Queues.size()) };
+		for (uint32_t offset{ 1 }; offset <= queueCount; ++offset)
+		{
+			WorkerQueue& queue{ *m_Queues[(thiefIndex + offset) % queueCount] };
+			std::lock_guard lock{ queue.mutex };
+			if (!queue.PopFront(job))
+				continue;
+
+			m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+		return false;
+	}
+
+	bool JobSystem::TryPopBackground(Job& job)
+	{
+		//Oldest first, background work is done in the order it was submitted
+		std::lock_guard lock{ m_BackgroundQueue.mutex };
+		if (!m_BackgroundQueue.PopFront(job))
+			return false;
+
+		m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	void JobSystem::Execute(Job& job)
+	{
+		if (job.pRangeFunction)
+			job.pRangeFunction(job.pRangeBody, job.first, job.last);
+		else
+			job.task();
+
+		job.pCounter->m_PendingJobs.fetch_sub(1, std::memory_order_release);
+	}
+
+	void JobSystem::WorkerQueue::PushBack(Job&& job)
+	{
+		//Doubles and unwraps, the oldest job moves to the front
+		if (count == jobs.size())
+		{
+			std::vector<Job> grownJobs(std::max(jobs.size() * 2, size_t(64)));
+			for (size_t i{}; i < count; ++i)
+				grownJobs[i] = std::move(jobs[(front + i) % jobs.size()]);
+
+			jobs = std::move(grownJobs);
+			front = 0;
+		}
+
+		jobs[(front + count) % jobs.size()] = std::move(job);
+		++count;
+	}
+
+	bool JobSystem::WorkerQueue::PopBack(Job& job)
+	{
+		if (count == 0)
+			return false;
+
+		--count;
+		job = std::move(jobs[(front + count) % jobs.size()]);
+		return true;
+	}
+
+	bool JobSystem::WorkerQueue::PopFront(Job& job)
+	{
+		if (count == 0)
+			return false;
+
+		job = std::move(jobs[front]);
+		front = (front + 1) % jobs.size();
+		--count;
+		return true;
+	}
+}
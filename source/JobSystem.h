@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dae
+{
+	//Unfinished jobs of one submission, JobSystem::Wait blocks on it
+	class JobCounter final
+	{
+	public:
+		bool IsDone() const { return m_PendingJobs.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+
+		std::atomic<uint32_t> m_PendingJobs{};
+	};
+
+	//Work stealing scheduler, every worker pushes and pops the back of its own deque and steals from the front of the others when idle
+	class JobSystem final
+	{
+	public:
+		//0 workers picks one less than the hardware threads, at least one
+		//Pinned workers each stay on one core the process may run on, only on Linux
+		//Opt in, pools of several systems in one process would be pinned to the same cores
+		//Up to boundThreadCount threads besides the workers and one unbound thread may submit, wait and run jobs, see BindThread
+		explicit JobSystem(uint32_t workerCount = 0, bool isPinned = false, uint32_t boundThreadCount = 0);
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem(JobSystem&&) noexcept = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+		JobSystem& operator=(JobSystem&&) noexcept = delete;
+
+		uint32_t GetWorkerCount() const { return uint32_t(m_Workers.size()); }
+		//Every index GetThreadIndex can return, the size of per thread data
+		uint32_t GetThreadCount() const { return GetWorkerCount() + 1 + m_BoundThreadCount; }
+		//Worker index + 1 on the workers, workers + 1 + slot on bound threads and 0 on any other thread,
+		//for per thread data like FrameArena sub-arenas
+		//Waiting threads run jobs of any submission, so only one unbound thread may take part at a time
+		uint32_t GetThreadIndex() const;
+		//Gives the calling thread a thread index of its own, each slot belongs to one thread at a time
+		void BindThread(uint32_t slot);
+
+		void Submit(std::function<void()> task, JobCounter& counter);
+		//For long jobs such as file I/O and decoding, only workers with nothing else to do run them
+		//Wait never runs them, so a frame that waits is not held up by one
+		void SubmitBackground(std::function<void()> task, JobCounter& counter);
+		//Runs queued jobs on the calling thread until every job of the counter finished, so jobs may wait on jobs
+		void Wait(const JobCounter& counter);
+
+		//Calls body(first, last) for consecutive chunks of at most grainSize indices in [begin, end)
+		//and returns when all of them finished, the calling thread takes part
+		//Chunks start at begin plus a multiple of grainSize, the body is shared and never copied or allocated
+		template<typename Body>
+		void ParallelFor(size_t begin, size_t end, size_t grainSize, const Body& body)
+		{
+			RunParallelFor(begin, end, grainSize, [](const void* pBody, size_t first, size_t last)
+			{
+				(*static_cast<const Body*>(pBody))(first, last);
+			}, &body);
+		}
+
+	private:
+		using RangeFunction = void(*)(const void* pBody, size_t first, size_t last);
+
+		struct Job
+		{
+			std::function<void()> task{};
+			RangeFunction pRangeFunction{};
+			const void* pRangeBody{};
+			size_t first{};
+			size_t last{};
+			JobCounter* pCounter{};
+		};
+
+		//Own cache line each, workers lock only their own queue unless they steal
+		//A ring buffer that only grows, so steady frames queue jobs without allocating
+		struct alignas(64) WorkerQueue
+		{
+			std::mutex mutex{};
+			std::vector<Job> jobs{};
+			size_t front{};
+			size_t count{};
+
+			void PushBack(Job&& job);
+			bool PopBack(Job& job);
+			bool PopFront(Job& job);
+		};
+
+		void RunParallelFor(size_t begin, size_t end, size_t grainSize, RangeFunction pRangeFunction, const void* pBody);
+
+		void WorkerLoop(uint32_t workerIndex);
+		void Push(Job&& job);
+		void WakeWorkers(uint32_t jobCount);
+		bool TryPop(Job& job);
+		bool TrySteal(uint32_t thiefIndex, Job& job);
+		bool TryPopBackground(Job& job);
+		static void Execute(Job& job);
+
+		std::vector<std::unique_ptr<WorkerQueue>> m_Queues{};
+		WorkerQueue m_BackgroundQueue{};
+		std::atomic<uint32_t> m_NextQueue{};
+		std::atomic<int> m_QueuedJobs{};
+		uint32_t m_BoundThreadCount{};
+
+		std::mutex m_SleepMutex{};
+		std::condition_variable m_JobAdded{};
+		bool m_IsStopping{ false };
+
+		//Last, so they start after everything they use is constructed
+		std::vector<std::thread> m_Workers{};
+	};
+}
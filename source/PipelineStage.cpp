@@ -0,0 +1,63 @@
+#include "PipelineStage.h"
+
+namespace dae
+{
+	PipelineStage::PipelineStage() :
+		m_Worker{ &PipelineStage::WorkerLoop, this }
+	{
+	}
+
+	PipelineStage::~PipelineStage()
+	{
+		//A running task still uses its owner's state, it finishes before the thread stops
+		Wait();
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_IsStopping = true;
+		}
+		m_TaskChanged.notify_all();
+
+		m_Worker.join();
+	}
+
+	void PipelineStage::Launch(std::function<void()> task)
+	{
+		{
+			std::unique_lock lock{ m_Mutex };
+			m_TaskChanged.wait(lock, [this]() { return !m_HasTask; });
+			m_Task = std::move(task);
+			m_HasTask = true;
+		}
+		m_TaskChanged.notify_all();
+	}
+
+	void PipelineStage::Wait()
+	{
+		std::unique_lock lock{ m_Mutex };
+		m_TaskChanged.wait(lock, [this]() { return !m_HasTask; });
+	}
+
+	void PipelineStage::WorkerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> task{};
+			{
+				std::unique_lock lock{ m_Mutex };
+				m_TaskChanged.wait(lock, [this]() { return m_IsStopping || m_HasTask; });
+				if (m_IsStopping)
+					return;
+
+				task = std::move(m_Task);
+			}
+
+			task();
+
+			{
+				std::lock_guard lock{ m_Mutex };
+				m_HasTask = false;
+			}
+			m_TaskChanged.notify_all();
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace dae
+{
+	//Runs one task at a time on its own thread, so a stage of the next frame overlaps the current frame
+	class PipelineStage final
+	{
+	public:
+		PipelineStage();
+		~PipelineStage();
+
+		PipelineStage(const PipelineStage&) = delete;
+		PipelineStage(PipelineStage&&) noexcept = delete;
+		PipelineStage& operator=(const PipelineStage&) = delete;
+		PipelineStage& operator=(PipelineStage&&) noexcept = delete;
+
+		//Waits for the previous task before handing over the next one
+		void Launch(std::function<void()> task);
+
+		//Blocks until the launched task returned
+		void Wait();
+
+	private:
+		void WorkerLoop();
+
+		std::function<void()> m_Task{};
+		std::mutex m_Mutex{};
+		std::condition_variable m_TaskChanged{};
+		bool m_HasTask{ false };
+		bool m_IsStopping{ false };
+		//Last, so it starts after everything it uses is constructed
+		std::thread m_Worker{};
+	};
+}
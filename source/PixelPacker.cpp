@@ -0,0 +1,62 @@
+#include "PixelPacker.h"
+#include <SDL_pixels.h>
+#include <cassert>
+#include <emmintrin.h>
+
+namespace dae
+{
+	PixelPacker::PixelPacker(const SDL_PixelFormat* pFormat) :
+		m_RedShift{ pFormat->Rshift },
+		m_GreenShift{ pFormat->Gshift },
+		m_BlueShift{ pFormat->Bshift },
+		m_AlphaMask{ pFormat->Amask }
+	{
+		assert(pFormat->BytesPerPixel == 4 && pFormat->Rloss == 0 && pFormat->Gloss == 0 && pFormat->Bloss == 0);
+	}
+
+	void PixelPacker::PackSpan(const ColorRGB* pColors, uint32_t* pPixels, size_t count) const
+	{
+		const __m128 zero{ _mm_setzero_ps() };
+		const __m128 one{ _mm_set1_ps(1.f) };
+		const __m128 maxIndex{ _mm_set1_ps(float(ColorSpace::g_LinearToSRGB.size() - 1)) };
+		const __m128 half{ _mm_set1_ps(.5f) };
+
+		const auto toIndices = [&](__m128 channel, int32_t* pIndices)
+		{
+			channel = _mm_min_ps(_mm_max_ps(channel, zero), one);
+			_mm_store_si128(reinterpret_cast<__m128i*>(pIndices), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(channel, maxIndex), half)));
+		};
+
+		size_t i{};
+		for (; i + 4 <= count; i += 4)
+		{
+			const ColorRGB* pQuad{ pColors + i };
+			__m128 r{ _mm_setr_ps(pQuad[0].r, pQuad[1].r, pQuad[2].r, pQuad[3].r) };
+			__m128 g{ _mm_setr_ps(pQuad[0].g, pQuad[1].g, pQuad[2].g, pQuad[3].g) };
+			__m128 b{ _mm_setr_ps(pQuad[0].b, pQuad[1].b, pQuad[2].b, pQuad[3].b) };
+
+			//MaxToOne, lanes whose largest channel is above one are divided by it
+			const __m128 maxChannel{ _mm_max_ps(r, _mm_max_ps(g, b)) };
+			const __m128 isAboveOne{ _mm_cmpgt_ps(maxChannel, one) };
+			const __m128 scale{ _mm_or_ps(_mm_and_ps(isAboveOne, _mm_div_ps(one, maxChannel)), _mm_andnot_ps(isAboveOne, one)) };
+			r = _mm_mul_ps(r, scale);
+			g = _mm_mul_ps(g, scale);
+			b = _mm_mul_ps(b, scale);
+
+			alignas(16) int32_t redIndices[4], greenIndices[4], blueIndices[4];
+			toIndices(r, redIndices);
+			toIndices(g, greenIndices);
+			toIndices(b, blueIndices);
+
+			for (size_t lane{}; lane < 4; ++lane)
+			{
+				pPixels[i + lane] = Pack(ColorSpace::g_LinearToSRGB[redIndices[lane]],
+					ColorSpace::g_LinearToSRGB[greenIndices[lane]],
+					ColorSpace::g_LinearToSRGB[blueIndices[lane]]);
+			}
+		}
+
+		for (; i < count; ++i)
+			pPixels[i] = Pack(pColors[i]);
+	}
+}
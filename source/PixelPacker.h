@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include "ColorRGB.h"
+#include "ColorSpace.h"
+
+struct SDL_PixelFormat;
+
+namespace dae
+{
+	//Writes linear colors as packed 32 bit pixels of a surface, the channel layout is resolved once
+	class PixelPacker final
+	{
+	public:
+		PixelPacker() = default;
+		//Expects 8 bits per channel and 4 bytes per pixel
+		explicit PixelPacker(const SDL_PixelFormat* pFormat);
+
+		//Already encoded bytes, alpha is opaque if the format has it
+		uint32_t Pack(uint8_t r, uint8_t g, uint8_t b) const
+		{
+			return (uint32_t(r) << m_RedShift) | (uint32_t(g) << m_GreenShift) | (uint32_t(b) << m_BlueShift) | m_AlphaMask;
+		}
+
+		//Scaled down like ColorRGB::MaxToOne, then sRGB encoded
+		uint32_t Pack(ColorRGB color) const
+		{
+			color.MaxToOne();
+			return Pack(ColorSpace::LinearToSRGB(color.r), ColorSpace::LinearToSRGB(color.g), ColorSpace::LinearToSRGB(color.b));
+		}
+
+		//Same as Pack per color, four colors at a time with SSE
+		void PackSpan(const ColorRGB* pColors, uint32_t* pPixels, size_t count) const;
+
+	private:
+		uint32_t m_RedShift{};
+		uint32_t m_GreenShift{ 8 };
+		uint32_t m_BlueShift{ 16 };
+		uint32_t m_AlphaMask{};
+	};
+}
@@ -0,0 +1,57 @@
+#include "PrimitiveAssembly.h"
+
+namespace dae
+{
+	namespace
+	{
+		void AddTriangle(std::vector<uint32_t>& triangleIndices, uint32_t index0, uint32_t index1, uint32_t index2)
+		{
+			//repeated indices stitch strips together, they cover no pixels
+			if (index0 == index1 || index1 == index2 || index2 == index0)
+				return;
+
+			triangleIndices.push_back(index0);
+			triangleIndices.push_back(index1);
+			triangleIndices.push_back(index2);
+		}
+	}
+
+	void AssembleTriangles(Mesh& mesh)
+	{
+		const std::vector<uint32_t>& indices{ mesh.indices };
+		std::vector<uint32_t>& triangleIndices{ mesh.triangleIndices };
+		triangleIndices.clear();
+
+		if (mesh.primitiveTopology == PrimitiveTopology::TriangeList)
+		{
+			triangleIndices.reserve(indices.size());
+			for (size_t index{}; index + 2 < indices.size(); index += 3)
+				AddTriangle(triangleIndices, indices[index], indices[index + 1], indices[index + 2]);
+			return;
+		}
+
+		//a strip of n indices has at most n - 2 triangles
+		triangleIndices.reserve(indices.size() < 3 ? 0 : (indices.size() - 2) * 3);
+
+		size_t stripStart{};
+		for (size_t index{}; index < indices.size(); ++index)
+		{
+			if (indices[index] == PrimitiveRestartIndex)
+			{
+				stripStart = index + 1;
+				continue;
+			}
+
+			//index closes the triangle that starts two indices earlier
+			const size_t stripIndex{ index - stripStart };
+			if (stripIndex < 2)
+				continue;
+
+			//odd triangles of a strip are wound the other way
+			if (stripIndex % 2 == 0)
+				AddTriangle(triangleIndices, indices[index - 2], indices[index - 1], indices[index]);
+			else
+				AddTriangle(triangleIndices, indices[index - 2], indices[index], indices[index - 1]);
+		}
+	}
+}
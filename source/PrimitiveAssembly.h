@@ -0,0 +1,10 @@
+#pragma once
+#include "DataTypes.h"
+
+namespace dae
+{
+	//Turns the indices of a mesh into a flat triangle list, three indices per triangle, in mesh.triangleIndices
+	//Strips restart at PrimitiveRestartIndex and alternate winding, degenerate triangles are dropped,
+	//so rasterizers walk every topology the same way without branching per triangle
+	void AssembleTriangles(Mesh& mesh);
+}
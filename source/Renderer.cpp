@@ -1,18 +1,41 @@
 //External includes
 #include "SDL.h"
 #include "SDL_surface.h"
+#include <algorithm>
 #include <iostream>
+#include <new>
 
 //Project includes
 #include "Renderer.h"
 #include "Math.h"
+#include "FrameArena.h"
+#include "JobSystem.h"
 #include "Matrix.h"
+#include "PipelineStage.h"
+#include "PrimitiveAssembly.h"
 #include "Texture.h"
+#include "TextureLoader.h"
+#include "TextureManager.h"
 #include "Utils.h"
 
 using namespace dae;
 
-Renderer::Renderer(SDL_Window* pWindow) :
+namespace
+{
+	//JobSystem slots of the stage threads, they run jobs while they wait and allocate from arena sub-arenas of their own
+	constexpr uint32_t g_GeometryStageSlot{ 0 };
+	constexpr uint32_t g_PresentStageSlot{ 1 };
+	constexpr uint32_t g_StageCount{ 2 };
+
+	//Screen space derivatives (ddx, ddy) of a value that varies linearly over a triangle
+	Vector2 CalculateGradient(const Vector2& edge01, const Vector2& edge02, float delta01, float delta02, float invDeterminant)
+	{
+		return { (delta01 * edge02.y - delta02 * edge01.y) * invDeterminant,
+				 (delta02 * edge01.x - delta01 * edge02.x) * invDeterminant };
+	}
+}
+
+Renderer::Renderer(SDL_Window* pWindow, uint32_t workerCount, bool isPinned) :
 	m_pWindow(pWindow)
 {
 	//Initialize
@@ -20,32 +43,178 @@ Renderer::Renderer(SDL_Window* pWindow) :
 
 	//Create Buffers
 	m_pFrontBuffer = SDL_GetWindowSurface(pWindow);
-	m_pBackBuffer = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
-	m_pBackBufferPixels = (uint32_t*)m_pBackBuffer->pixels;
+	//The present thread converts one back buffer into the window surface while the next frame renders into the other
+	m_BackBufferCount = 2;
+	for (int i{}; i < m_BackBufferCount; ++i)
+		m_pBackBuffers[i] = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
+	m_pPresentStage = new PipelineStage();
+
+	Initialize(workerCount, isPinned);
+}
+
+Renderer::Renderer(int width, int height, uint32_t workerCount, bool isPinned) :
+	m_Width{ width },
+	m_Height{ height }
+{
+	//Cache line aligned pixels, wrapped in a surface so saving and blitting still go through SDL
+	m_pHeadlessPixels = static_cast<uint32_t*>(::operator new[](size_t(m_Width) * m_Height * sizeof(uint32_t), std::align_val_t{ 64 }));
+	m_BackBufferCount = 1;
+	m_pBackBuffers[0] = SDL_CreateRGBSurfaceWithFormatFrom(m_pHeadlessPixels, m_Width, m_Height, 32, m_Width * int(sizeof(uint32_t)), SDL_PIXELFORMAT_RGB888);
+
+	Initialize(workerCount, isPinned);
+}
+
+void Renderer::Initialize(uint32_t workerCount, bool isPinned)
+{
+	//The render thread is the one unbound thread, the stage threads bind a slot each
+	m_pJobSystem = new JobSystem(workerCount, isPinned, g_StageCount);
+	m_pFrameArena = new FrameArena(m_pJobSystem->GetThreadCount(), 256 * 1024);
+	m_pGeometryArena = new FrameArena(m_pJobSystem->GetThreadCount(), 16 * 1024);
+	if (m_pPresentStage)
+		m_pPresentStage->Launch([this]() { m_pJobSystem->BindThread(g_PresentStageSlot); });
 
-	m_pDepthBufferPixels = new float[m_Width * m_Height];
+	m_pBackBuffer = m_pBackBuffers[m_DrawBuffer];
+	m_pBackBufferPixels = static_cast<uint32_t*>(m_pBackBuffer->pixels);
+	m_PixelPacker = PixelPacker{ m_pBackBuffer->format };
 
 	//Initialize Camera
 	m_Camera.Initialize(60.f, { .0f,.0f,-10.f });
+	m_Camera.CalculateViewMatrix();
+
+	SetDepthFormat(DepthFormat::Float32, true);
+	m_TileBinner = TileBinner{ m_Width, m_Height, m_FrameClearers[0].GetTileSize() };
+
+	//Initialize Texture, decoded on the workers while the first frames show a placeholder
+	m_pTextureLoader = new TextureLoader(*m_pJobSystem);
+
+	TextureLoadSettings textureSettings{};
+	textureSettings.filter = TextureFilter::Trilinear;
+	textureSettings.addressMode = AddressMode::Clamp;
+	m_pTexture = m_pTextureLoader->LoadAsync("resources/uv_grid_2.png", textureSettings);
+
+	//Mip levels that go unsampled are evicted once the textures of every renderer together exceed the budget
+	m_pTextureManager = &TextureManager::GetShared();
+	m_pTextureManager->Register(m_pTexture, *m_pTextureLoader);
+
+	//Define Mesh
+	m_Meshes =
+	{
+		Mesh{
+				{
+					Vertex{{-3, 3, -2}, {}, {0, 0}},
+					Vertex{{0, 3, -2}, {}, {.5f, 0}},
+					Vertex{{3, 3, -2}, {},  {1, 0}},
+					Vertex{{-3, 0, -2}, {},  {0, .5}},
+					Vertex{{0, 0, -2}, {},  {.5, .5}},
+					Vertex{{3, 0, -2}, {}, {1, .5}},
+					Vertex{{-3, -3, -2}, {}, {0, 1}},
+					Vertex{{0, -3, -2}, {}, {.5, 1}},
+					Vertex{{3, -3, -2}, {}, {1, 1}}
+				},
+				{
+					3, 0, 4, 1, 5, 2,
+					PrimitiveRestartIndex,
+					6, 3, 7, 4, 8, 5
+				},
+				PrimitiveTopology::TriangleStrip
+		}
+	};
+	for (Mesh& mesh : m_Meshes)
+	{
+		mesh.SplitStreams();
+		AssembleTriangles(mesh);
+	}
 
-	//Initialize Texture
-	m_pTexture = Texture::LoadFromFile("resources/uv_grid_2.png");
+	//Windowed frames overlap, offline frames have to show the camera they were rendered with
+	SetFramePipelining(m_pWindow != nullptr);
 }
 
 Renderer::~Renderer()
 {
-	delete[] m_pDepthBufferPixels;
-	delete m_pTexture;
+	//Finishes the geometry of a frame that was updated but never rendered, and the last conversion
+	delete m_pGeometryStage;
+	delete m_pPresentStage;
+	//Finishes the loads and reloads in flight on the workers before the handle they publish to goes away
+	delete m_pTextureLoader;
+	m_pTextureManager->Unregister(m_pTexture);
+	delete m_pJobSystem;
+	delete m_pFrameArena;
+	delete m_pGeometryArena;
+	delete m_pDepthBuffer;
+
+	for (int i{}; i < m_BackBufferCount; ++i)
+		SDL_FreeSurface(m_pBackBuffers[i]);
+	if (m_pHeadlessPixels)
+		::operator delete[](m_pHeadlessPixels, std::align_val_t{ 64 });
 }
 
 void Renderer::Update(Timer* pTimer)
 {
-	m_Camera.Update(pTimer);
+	if (!m_pGeometryStage)
+	{
+		UpdateCamera(pTimer);
+		return;
+	}
+
+	//Input was pumped before Update and is only polled again after Render waited for this stage
+	//The buffers only swap after that wait as well. Two captures fit std::function without allocating
+	m_pGeometryStage->Launch([this, pTimer]()
+	{
+		UpdateCamera(pTimer);
+		TransformGeometry(m_ScreenSpacePositions[1 - m_RasterBuffer]);
+	});
+	m_IsGeometryPending = true;
+}
+
+void Renderer::UpdateCamera(Timer* pTimer)
+{
+	//Without a window there is no input, the camera is set from outside
+	if (m_pWindow)
+		m_Camera.Update(pTimer);
+	else
+		m_Camera.CalculateViewMatrix();
+}
+
+void Renderer::SetFramePipelining(bool isPipelined)
+{
+	if (isPipelined == IsFramePipelined())
+		return;
+
+	//The old stage thread has stopped before the new one binds the slot
+	delete m_pGeometryStage;
+	m_pGeometryStage = isPipelined ? new PipelineStage() : nullptr;
+	if (m_pGeometryStage)
+		m_pGeometryStage->Launch([this]() { m_pJobSystem->BindThread(g_GeometryStageSlot); });
+	m_IsGeometryPending = false;
+	m_HasRasterGeometry = false;
+}
+
+void Renderer::FinishGeometry()
+{
+	m_pGeometryStage->Wait();
+	m_RasterBuffer = 1 - m_RasterBuffer;
+	m_IsGeometryPending = false;
+	m_HasRasterGeometry = true;
 }
 
 void Renderer::Render()
 {
 	//@START
+	//The present thread may still read the previous frame, this one goes into the other buffer
+	if (m_pPresentStage)
+	{
+		//SDL wants the window updated from the thread that created it
+		if (m_IsPresentPending)
+		{
+			m_pPresentStage->Wait();
+			SDL_UpdateWindowSurface(m_pWindow);
+			m_IsPresentPending = false;
+		}
+		m_DrawBuffer = 1 - m_DrawBuffer;
+		m_pBackBuffer = m_pBackBuffers[m_DrawBuffer];
+		m_pBackBufferPixels = static_cast<uint32_t*>(m_pBackBuffer->pixels);
+	}
+
 	//Lock BackBuffer
 	SDL_LockSurface(m_pBackBuffer);
 
@@ -58,13 +227,37 @@ void Renderer::Render()
 	//Render_W2_Part1();
 	//Render_W2_Part2TriangleList();
 	//Render_W2_Part2TriangleStrip();
-	Render_W2_UVCoordinates();
+	if (m_pGeometryStage)
+	{
+		//The first frame has no previous one to overlap with
+		if (!m_HasRasterGeometry && m_IsGeometryPending)
+			FinishGeometry();
+		if (m_HasRasterGeometry)
+			RasterizeUVCoordinates(m_ScreenSpacePositions[m_RasterBuffer]);
+	}
+	else
+		Render_W2_UVCoordinates();
 
 	//@END
 	//Update SDL Surface
 	SDL_UnlockSurface(m_pBackBuffer);
-	SDL_BlitSurface(m_pBackBuffer, 0, m_pFrontBuffer, 0);
-	SDL_UpdateWindowSurface(m_pWindow);
+	if (m_pPresentStage)
+	{
+		//Only the conversion into the window surface overlaps, the next Render shows it
+		SDL_Surface* pFinishedBuffer{ m_pBackBuffer };
+		m_pPresentStage->Launch([this, pFinishedBuffer]()
+		{
+			SDL_BlitSurface(pFinishedBuffer, 0, m_pFrontBuffer, 0);
+		});
+		m_IsPresentPending = true;
+	}
+
+	//Triangles and bins of this frame are no longer needed
+	m_pFrameArena->Reset();
+
+	//The next frame is rasterized from what the geometry stage transformed meanwhile
+	if (m_IsGeometryPending)
+		FinishGeometry();
 }
 
 void Renderer::VertexTransformationFunction(const std::vector<Vertex>& vertices_in, std::vector<Vertex>& vertices_out) const
@@ -93,174 +286,373 @@ void Renderer::VertexTransformationFunction(const std::vector<Vertex>& vertices_
 
 void Renderer::VertexTransformationFunction(const std::vector<Mesh>& vertices_in, std::vector<Vertex>& vertices_out) const
 {
-	const float aspectRatio{ float(m_Width) / float(m_Height) };
+	TransformMeshes(vertices_in, vertices_out, [](const Mesh& mesh) { return mesh.vertices.size(); },
+		[this, aspectRatio = float(m_Width) / float(m_Height)](const Mesh& mesh, size_t vertexIndex, Vertex& vertexProjected)
+	{
+		const Vertex& vertexWorldspace{ mesh.vertices[vertexIndex] };
+		vertexProjected.position = TransformToScreen(vertexWorldspace.position, aspectRatio);
+		//Copy color and uv
+		vertexProjected.color = vertexWorldspace.color;
+		vertexProjected.uv = vertexWorldspace.uv;
+	});
+}
 
-	for (const Mesh& mesh : vertices_in)
+void Renderer::VertexTransformationFunction(const std::vector<Mesh>& meshes_in, std::vector<VertexPosition>& positions_out) const
+{
+	//The attributes don't change, setup reads them straight from the mesh
+	TransformMeshes(meshes_in, positions_out, [](const Mesh& mesh) { return mesh.positions.size(); },
+		[this, aspectRatio = float(m_Width) / float(m_Height)](const Mesh& mesh, size_t vertexIndex, VertexPosition& positionProjected)
 	{
-		for (const Vertex& vertexWorldspace : mesh.vertices)
+		positionProjected.position = TransformToScreen(mesh.positions[vertexIndex].position, aspectRatio);
+	});
+}
+
+template<typename Output, typename CountVertices, typename TransformVertex>
+void Renderer::TransformMeshes(const std::vector<Mesh>& meshes_in, std::vector<Output>& out, CountVertices&& countVertices, TransformVertex&& transformVertex) const
+{
+	//Where every mesh starts in the output, so any chunk of vertices knows where to write without appending
+	//Only one thread transforms at a time, the scratch of the previous call is no longer needed
+	m_pGeometryArena->Reset();
+	const size_t meshCount{ meshes_in.size() };
+	//Sub-arenas belong to one thread each: workers, bound stage threads and the render thread all have their own index
+	size_t* meshOffsets{ m_pGeometryArena->Allocate<size_t>(m_pJobSystem->GetThreadIndex(), meshCount + 1) };
+	meshOffsets[0] = out.size();
+	for (size_t meshIndex{}; meshIndex < meshCount; ++meshIndex)
+		meshOffsets[meshIndex + 1] = meshOffsets[meshIndex] + countVertices(meshes_in[meshIndex]);
+	out.resize(meshOffsets[meshCount]);
+
+	//Chunks run over all meshes at once, so many small meshes spread as well as one big one
+	m_pJobSystem->ParallelFor(meshOffsets[0], meshOffsets[meshCount], 4096, [&](size_t first, size_t last)
+	{
+		size_t meshIndex{ size_t(std::upper_bound(meshOffsets, meshOffsets + meshCount + 1, first) - meshOffsets) - 1 };
+
+		for (size_t outIndex{ first }; outIndex < last; ++outIndex)
 		{
-			//World space to View space
-			Vertex vertexViewspace{};
-			vertexViewspace.position = m_Camera.viewMatrix.TransformPoint(vertexWorldspace.position);
-			//Apply perspective divide
-			Vertex vertexProjected{};
-			vertexProjected.position.x = vertexViewspace.position.x / vertexViewspace.position.z;
-			vertexProjected.position.y = vertexViewspace.position.y / vertexViewspace.position.z;
-			vertexProjected.position.z = vertexViewspace.position.z;
-			//Relative to screen
-			vertexProjected.position.x /= (aspectRatio * m_Camera.fov);
-			vertexProjected.position.y /= m_Camera.fov;
-			vertexProjected.position.x = ((vertexProjected.position.x + 1) / 2.f) * m_Width;
-			vertexProjected.position.y = ((1 - vertexProjected.position.y) / 2.f) * m_Height;
-			//Copy color and uv
-			vertexProjected.color = vertexWorldspace.color;
-			vertexProjected.uv = vertexWorldspace.uv;
-			vertices_out.emplace_back(vertexProjected);
+			while (outIndex >= meshOffsets[meshIndex + 1])
+				++meshIndex;
+
+			transformVertex(meshes_in[meshIndex], outIndex - meshOffsets[meshIndex], out[outIndex]);
 		}
-	}
+	});
+}
+
+Vector3 Renderer::TransformToScreen(const Vector3& worldPosition, float aspectRatio) const
+{
+	//World space to View space
+	const Vector3 viewPosition{ m_Camera.viewMatrix.TransformPoint(worldPosition) };
+	//Apply perspective divide
+	Vector3 projectedPosition{};
+	projectedPosition.x = viewPosition.x / viewPosition.z;
+	projectedPosition.y = viewPosition.y / viewPosition.z;
+	projectedPosition.z = viewPosition.z;
+	//Relative to screen
+	projectedPosition.x /= (aspectRatio * m_Camera.fov);
+	projectedPosition.y /= m_Camera.fov;
+	projectedPosition.x = ((projectedPosition.x + 1) / 2.f) * m_Width;
+	projectedPosition.y = ((1 - projectedPosition.y) / 2.f) * m_Height;
+	return projectedPosition;
+}
+
+void Renderer::SetDepthFormat(DepthFormat format, bool isReversed)
+{
+	delete m_pDepthBuffer;
+	m_pDepthBuffer = new DepthBuffer(m_Width, m_Height, format, isReversed, m_Camera.nearPlane, m_Camera.farPlane);
+	for (int i{}; i < m_BackBufferCount; ++i)
+		m_FrameClearers[i] = FrameClearer{ static_cast<uint32_t*>(m_pBackBuffers[i]->pixels), m_pDepthBuffer, m_Width, m_Height, m_pJobSystem };
+}
+
+uint32_t Renderer::WaitForTextures()
+{
+	return m_pTextureLoader->WaitIdle();
 }
 
 bool Renderer::SaveBufferToImage() const
 {
-	return SDL_SaveBMP(m_pBackBuffer, "Rasterizer_ColorBuffer.bmp");
+	return SaveBufferToImage("Rasterizer_ColorBuffer.bmp");
+}
+
+bool Renderer::SaveBufferToImage(const std::string& path) const
+{
+	//Converting for the file blits from the same surface the present thread blits from
+	if (m_pPresentStage)
+		m_pPresentStage->Wait();
+
+	return SDL_SaveBMP(m_pBackBuffer, path.c_str());
 }
 
 void Renderer::Render_W2_UVCoordinates()
 {
-	//Define Mesh
-	std::vector<Mesh> vertices_world
-	{
-		Mesh{
-				{
-					Vertex{{-3, 3, -2}, {}, {0, 0}},
-					Vertex{{0, 3, -2}, {}, {.5f, 0}},
-					Vertex{{3, 3, -2}, {},  {1, 0}},
-					Vertex{{-3, 0, -2}, {},  {0, .5}},
-					Vertex{{0, 0, -2}, {},  {.5, .5}},
-					Vertex{{3, 0, -2}, {}, {1, .5}},
-					Vertex{{-3, -3, -2}, {}, {0, 1}},
-					Vertex{{0, -3, -2}, {}, {.5, 1}},
-					Vertex{{3, -3, -2}, {}, {1, 1}}
-				},
-				{
-					3, 0, 4, 1, 5, 2,
-					2, 6,
-					6, 3, 7, 4, 8, 5
-				},
-				PrimitiveTopology::TriangleStrip
-		}
-	};
+	std::vector<VertexPosition>& positions_ScreenSpace{ m_ScreenSpacePositions[m_RasterBuffer] };
+	TransformGeometry(positions_ScreenSpace);
+	RasterizeUVCoordinates(positions_ScreenSpace);
+}
 
-	//std::cout << vertices_world[0].vertices[1].uv.x << '\n';
-	
-	std::vector<Vertex> vertices_ScreenSpace;
-	vertices_ScreenSpace.reserve(vertices_world[0].vertices.size());
+void Renderer::TransformGeometry(std::vector<VertexPosition>& positions_ScreenSpace) const
+{
+	//keeps its capacity, so steady frames do not allocate
+	positions_ScreenSpace.clear();
+	VertexTransformationFunction(m_Meshes, positions_ScreenSpace);
+}
 
-	VertexTransformationFunction(vertices_world, vertices_ScreenSpace);
+void Renderer::RasterizeUVCoordinates(const std::vector<VertexPosition>& positions_ScreenSpace)
+{
+	const std::vector<uint32_t>& triangleIndices{ m_Meshes[0].triangleIndices };
+	const std::vector<VertexAttributes>& attributes{ m_Meshes[0].attributes };
 
-	std::fill_n(m_pDepthBufferPixels, m_Width * m_Height, FLT_MAX);
-	SDL_FillRect(m_pBackBuffer, NULL, SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100));
+	//only tiles drawn to last frame are cleared
+	m_FrameClearers[m_DrawBuffer].Clear(m_PixelPacker.Pack(100, 100, 100));
 
-	//for each triangle
-	for (int index{}; index < vertices_world[0].indices.size() - 2; ++index)
+	//placeholder until the texture finished loading
+	const Texture& texture{ m_pTexture->Get() };
+
+	//triangle setup and binning, chunks of the triangle list in parallel, everything in the frame arena
+	//Sub-arenas belong to one thread each, the geometry stage may run these jobs too but binds an index of its own
+	const uint32_t threadIndex{ m_pJobSystem->GetThreadIndex() };
+	const size_t triangleCount{ triangleIndices.size() / 3 };
+	RasterTriangle* pTriangles{ m_pFrameArena->Allocate<RasterTriangle>(threadIndex, triangleCount) };
+
+	constexpr size_t trianglesPerChunk{ 256 };
+	m_TileBinner.Reset(*m_pFrameArena, threadIndex, uint32_t((triangleCount + trianglesPerChunk - 1) / trianglesPerChunk));
+
+	m_pJobSystem->ParallelFor(0, triangleCount, trianglesPerChunk, [&](size_t first, size_t last)
 	{
-		Vertex vertex0{}, vertex1{}, vertex2{};
+		//ParallelFor chunks start at multiples of the grain size, so the chunk of a triangle is fixed
+		const uint32_t chunkIndex{ uint32_t(first / trianglesPerChunk) };
+		const uint32_t jobThreadIndex{ m_pJobSystem->GetThreadIndex() };
 
-		if (index % 2 == 0)
+		//for each triangle
+		for (size_t index{ first }; index < last; ++index)
 		{
-			vertex0 = vertices_ScreenSpace[vertices_world[0].indices[index]];
-			vertex1 = vertices_ScreenSpace[vertices_world[0].indices[index + 1]];
-			vertex2 = vertices_ScreenSpace[vertices_world[0].indices[index + 2]];
+			RasterTriangle& triangle{ pTriangles[index] };
+
+			const uint32_t index0{ triangleIndices[index * 3] };
+			const uint32_t index1{ triangleIndices[index * 3 + 1] };
+			const uint32_t index2{ triangleIndices[index * 3 + 2] };
+
+			const Vector3& position0{ triangle.position0 = positions_ScreenSpace[index0].position };
+			const Vector3& position1{ triangle.position1 = positions_ScreenSpace[index1].position };
+			const Vector3& position2{ triangle.position2 = positions_ScreenSpace[index2].position };
+			const Vector2& uv0{ triangle.uv0 = attributes[index0].uv };
+			const Vector2& uv1{ triangle.uv1 = attributes[index1].uv };
+			const Vector2& uv2{ triangle.uv2 = attributes[index2].uv };
+
+			//triangle edges
+			triangle.edgeA = Vector2{ Vector2(position0.x, position0.y),
+									  Vector2(position1.x, position1.y) };
+			triangle.edgeB = Vector2{ Vector2(position1.x, position1.y),
+									  Vector2(position2.x, position2.y) };
+			triangle.edgeC = Vector2{ Vector2(position2.x, position2.y),
+									  Vector2(position0.x, position0.y) };
+
+			//gradients of 1/z, u/z and v/z, from which the per pixel uv derivatives follow
+			const Vector2 edge02{ -triangle.edgeC };
+			const float invDeterminant{ 1.f / Vector2::Cross(triangle.edgeA, edge02) };
+			const float invZ0{ 1.f / position0.z };
+			const float invZ1{ 1.f / position1.z };
+			const float invZ2{ 1.f / position2.z };
+			triangle.invZGradient = CalculateGradient(triangle.edgeA, edge02, invZ1 - invZ0, invZ2 - invZ0, invDeterminant);
+			triangle.uOverZGradient = CalculateGradient(triangle.edgeA, edge02,
+				uv1.x * invZ1 - uv0.x * invZ0, uv2.x * invZ2 - uv0.x * invZ0, invDeterminant);
+			triangle.vOverZGradient = CalculateGradient(triangle.edgeA, edge02,
+				uv1.y * invZ1 - uv0.y * invZ0, uv2.y * invZ2 - uv0.y * invZ0, invDeterminant);
+
+			const float smallestX{ std::min({ position0.x, position1.x, position2.x }) };
+			const float smallestY{ std::min({ position0.y, position1.y, position2.y }) };
+			const float largestX{ std::max({ position0.x, position1.x, position2.x }) };
+			const float largestY{ std::max({ position0.y, position1.y, position2.y }) };
+
+			//entirely off screen, no tile has to look at it
+			if (largestX < 0.f || largestY < 0.f || smallestX > float(m_Width - 1) || smallestY > float(m_Height - 1))
+				continue;
+
+			Int2 pMin, pMax;
+			pMin.x = Clamp(int(smallestX), 0, m_Width - 1);
+			pMin.y = Clamp(int(smallestY), 0, m_Height - 1);
+			pMax.x = Clamp(int(largestX), 0, m_Width - 1);
+			pMax.y = Clamp(int(largestY), 0, m_Height - 1);
+			m_TileBinner.Add(jobThreadIndex, chunkIndex, uint32_t(index), pMin, pMax);
+
+			triangle.pMin = pMin;
+			triangle.pMax = pMax;
 		}
-		else
+	});
+
+	//one job per tile, its triangles in submission order, so depth ties resolve the same for any worker count
+	m_pJobSystem->ParallelFor(0, size_t(m_TileBinner.GetTileCount()), 1, [&](size_t firstTile, size_t lastTile)
+	{
+		for (int tileIndex{ int(firstTile) }; tileIndex < int(lastTile); ++tileIndex)
 		{
-			vertex0 = vertices_ScreenSpace[vertices_world[0].indices[index]];
-			vertex1 = vertices_ScreenSpace[vertices_world[0].indices[index + 2]];
-			vertex2 = vertices_ScreenSpace[vertices_world[0].indices[index + 1]];
-		}
+			Int2 tileMin, tileMax;
+			m_TileBinner.GetTileBounds(tileIndex, tileMin, tileMax);
 
-		//triangle edges
-		Vector2 edgeA{ Vector2(vertex0.position.x, vertex0.position.y),
-					   Vector2(vertex1.position.x, vertex1.position.y) };
-		Vector2 edgeB{ Vector2(vertex1.position.x, vertex1.position.y),
-					   Vector2(vertex2.position.x, vertex2.position.y) };
-		Vector2 edgeC{ Vector2(vertex2.position.x, vertex2.position.y),
-					   Vector2(vertex0.position.x, vertex0.position.y) };
+			m_TileBinner.ForEachTriangle(tileIndex, [&](uint32_t triangleIndex)
+			{
+				const RasterTriangle& triangle{ pTriangles[triangleIndex] };
 
-		float smallestX{ vertex0.position.x };
-		smallestX = std::min(smallestX, vertex1.position.x);
-		smallestX = std::min(smallestX, vertex2.position.x);
+				const Int2 pMin{ std::max(triangle.pMin.x, tileMin.x), std::max(triangle.pMin.y, tileMin.y) };
+				const Int2 pMax{ std::min(triangle.pMax.x, tileMax.x), std::min(triangle.pMax.y, tileMax.y) };
 
-		float smallestY{ vertex0.position.y };
-		smallestY = std::min(smallestY, vertex1.position.y);
-		smallestY = std::min(smallestY, vertex2.position.y);
+				//the depth buffer is shared, so the tile is dirty for every back buffer
+				//clearer tiles are the bin tiles, a job only ever touches the flag of its own tile
+				for (int i{}; i < m_BackBufferCount; ++i)
+					m_FrameClearers[i].MarkDirty(pMin.x, pMin.y, pMax.x, pMax.y);
 
-		float largestX{ vertex0.position.x };
-		largestX = std::max(largestX, vertex1.position.x);
-		largestX = std::max(largestX, vertex2.position.x);
+				RasterizeTriangle(triangle, texture, pMin, pMax);
+			});
+		}
+	});
+}
 
-		float largestY{ vertex0.position.y };
-		largestY = std::max(largestY, vertex1.position.y);
-		largestY = std::max(largestY, vertex2.position.y);
+void Renderer::RasterizeTriangle(const RasterTriangle& triangle, const Texture& texture, const Int2& pMin, const Int2& pMax)
+{
+	const Vector3& position0{ triangle.position0 };
+	const Vector3& position1{ triangle.position1 };
+	const Vector3& position2{ triangle.position2 };
+	const Vector2& uv0{ triangle.uv0 };
+	const Vector2& uv1{ triangle.uv1 };
+	const Vector2& uv2{ triangle.uv2 };
+	const Vector2& edgeA{ triangle.edgeA };
+	const Vector2& edgeB{ triangle.edgeB };
+	const Vector2& edgeC{ triangle.edgeC };
+	const Vector2& invZGradient{ triangle.invZGradient };
+	const Vector2& uOverZGradient{ triangle.uOverZGradient };
+	const Vector2& vOverZGradient{ triangle.vOverZGradient };
+
+	//covered pixels of a row are shaded in spans, one texture call per span
+	constexpr int spanSize{ 8 };
+	Vector2 spanUVs[spanSize]{};
+	int spanPixels[spanSize]{};
+	ColorRGB spanColors[spanSize]{};
+	int spanCount{};
+	float spanLOD{};
+
+	const auto shadeSpan = [&]()
+	{
+		texture.SampleSpan(spanUVs, spanLOD, spanColors, spanCount);
 
-		Int2 pMin, pMax;
-		pMin.x = Clamp(int(smallestX), 0, m_Width);
-		pMin.y = Clamp(int(smallestY), 0, m_Height);
-		pMax.x = Clamp(int(largestX), 0, m_Width);
-		pMax.y = Clamp(int(largestY), 0, m_Height);
+		uint32_t pixels[spanSize]{};
+		m_PixelPacker.PackSpan(spanColors, pixels, spanCount);
 
-		//for every pixel
+		//Update Color in Buffer
+		for (int i{}; i < spanCount; ++i)
+			m_pBackBufferPixels[spanPixels[i]] = pixels[i];
+		spanCount = 0;
+	};
+
+	//for every pixel
+	for (int py{ pMin.y }; py <= pMax.y; ++py)
+	{
 		for (int px{ pMin.x }; px <= pMax.x; ++px)
 		{
-			for (int py{ pMin.y }; py <= pMax.y; ++py)
-			{
-				const Vector2 pixel{ float(px), float(py) };
+			const Vector2 pixel{ float(px), float(py) };
 
-				Vector2 vertex0ToPixel{ Vector2(vertex0.position.x, vertex0.position.y), pixel };
-				float crossA = Vector2::Cross(edgeA, vertex0ToPixel);
+			Vector2 vertex0ToPixel{ Vector2(position0.x, position0.y), pixel };
+			float crossA = Vector2::Cross(edgeA, vertex0ToPixel);
 
-				Vector2 vertex1ToPixel{ Vector2(vertex1.position.x, vertex1.position.y), pixel };
-				float crossB = Vector2::Cross(edgeB, vertex1ToPixel);
+			Vector2 vertex1ToPixel{ Vector2(position1.x, position1.y), pixel };
+			float crossB = Vector2::Cross(edgeB, vertex1ToPixel);
 
-				Vector2 vertex2ToPixel{ Vector2(vertex2.position.x, vertex2.position.y), pixel };
-				float crossC = Vector2::Cross(edgeC, vertex2ToPixel);
+			Vector2 vertex2ToPixel{ Vector2(position2.x, position2.y), pixel };
+			float crossC = Vector2::Cross(edgeC, vertex2ToPixel);
 
-				ColorRGB finalColor{};
+			//if pixel is inside triangle
+			if (crossA > 0 && crossB > 0 && crossC > 0)
+			{
+				const float totalArea = Vector2::Cross(edgeA, edgeB);
+				const float W0{ Vector2::Cross(edgeB, vertex1ToPixel) / totalArea };
+				const float W1{ Vector2::Cross(edgeC, vertex2ToPixel) / totalArea };
+				const float W2{ Vector2::Cross(edgeA, vertex0ToPixel) / totalArea };
 
-				//if pixel is inside triangle
-				if (crossA > 0 && crossB > 0 && crossC > 0)
+				const float zInterpolated = 1.f / ((1.f / position0.z) * W0 + (1.f / position1.z) * W1 + (1.f / position2.z) * W2);
+
+				if (m_pDepthBuffer->TestAndWrite(py * m_Width + px, zInterpolated))
 				{
-					const float totalArea = Vector2::Cross(edgeA, edgeB);
-					const float W0{ Vector2::Cross(edgeB, vertex1ToPixel) / totalArea };
-					const float W1{ Vector2::Cross(edgeC, vertex2ToPixel) / totalArea };
-					const float W2{ Vector2::Cross(edgeA, vertex0ToPixel) / totalArea };
+					Vector2 interpolatedUV = ((uv0 / position0.z * W0) + (uv1 / position1.z * W1)
+						+ (uv2 / position2.z * W2)) * zInterpolated;
 
-					const float pixelDepth = vertex0.position.z * W0 + vertex1.position.z * W1 + vertex2.position.z * W2;
+					//the first pixel of a span picks the level of detail for the whole span
+					if (spanCount == 0)
+					{
+						const Vector2 dUVdx{ (uOverZGradient.x - interpolatedUV.x * invZGradient.x) * zInterpolated,
+											 (vOverZGradient.x - interpolatedUV.y * invZGradient.x) * zInterpolated };
+						const Vector2 dUVdy{ (uOverZGradient.y - interpolatedUV.x * invZGradient.y) * zInterpolated,
+											 (vOverZGradient.y - interpolatedUV.y * invZGradient.y) * zInterpolated };
+						spanLOD = texture.CalculateLOD(dUVdx, dUVdy);
+					}
 
-					const float zInterpolated = 1.f / ((1.f / vertex0.position.z) * W0 + (1.f / vertex1.position.z) * W1 + (1.f / vertex2.position.z) * W2);
+					spanUVs[spanCount] = interpolatedUV;
+					spanPixels[spanCount] = px + (py * m_Width);
+					if (++spanCount == spanSize)
+						shadeSpan();
+				}
+			}
+		}
 
-					if (zInterpolated < m_pDepthBufferPixels[py * m_Width + px])
-					{
-						m_pDepthBufferPixels[py * m_Width + px] = zInterpolated;
+		if (spanCount > 0)
+			shadeSpan();
+	}
+}
 
-						//finalColor = vertex0.color * W0 + vertex1.color * W1 + vertex2.color * W2;
+void Renderer::RasterizeMesh(const Mesh& mesh, const std::vector<Vertex>& vertices_ScreenSpace)
+{
+	const std::vector<uint32_t>& triangleIndices{ mesh.triangleIndices };
 
-						//Vector2 interpolatedUV{ vertex0.uv * W0 + vertex1.uv * W1 + vertex2.uv * W2 };
-						Vector2 interpolatedUV = ((vertex0.uv / vertex0.position.z * W0) + (vertex1.uv / vertex1.position.z * W1)
-							+ (vertex2.uv / vertex2.position.z * W2)) * zInterpolated;
+	//for each triangle
+	for (size_t index{}; index < triangleIndices.size(); index += 3)
+	{
+		const Vertex& vertex0{ vertices_ScreenSpace[triangleIndices[index]] };
+		const Vertex& vertex1{ vertices_ScreenSpace[triangleIndices[index + 1]] };
+		const Vertex& vertex2{ vertices_ScreenSpace[triangleIndices[index + 2]] };
 
-						finalColor = m_pTexture->Sample(interpolatedUV);
-						//std::cout << finalColor.r << ' ' << finalColor.g << ' ' << finalColor.b << '\n';
+		//triangle edges
+		const Vector2 edgeA{ Vector2(vertex0.position.x, vertex0.position.y),
+							 Vector2(vertex1.position.x, vertex1.position.y) };
+		const Vector2 edgeB{ Vector2(vertex1.position.x, vertex1.position.y),
+							 Vector2(vertex2.position.x, vertex2.position.y) };
+		const Vector2 edgeC{ Vector2(vertex2.position.x, vertex2.position.y),
+							 Vector2(vertex0.position.x, vertex0.position.y) };
+		const float totalArea{ Vector2::Cross(edgeA, edgeB) };
+
+		//bounding box, clamped to the last pixel so it never wraps into the next row
+		Int2 pMin, pMax;
+		pMin.x = Clamp(int(std::min({ vertex0.position.x, vertex1.position.x, vertex2.position.x })), 0, m_Width - 1);
+		pMin.y = Clamp(int(std::min({ vertex0.position.y, vertex1.position.y, vertex2.position.y })), 0, m_Height - 1);
+		pMax.x = Clamp(int(std::max({ vertex0.position.x, vertex1.position.x, vertex2.position.x })), 0, m_Width - 1);
+		pMax.y = Clamp(int(std::max({ vertex0.position.y, vertex1.position.y, vertex2.position.y })), 0, m_Height - 1);
 
-						//Update Color in Buffer
-						finalColor.MaxToOne();
+		//for every pixel
+		for (int py{ pMin.y }; py <= pMax.y; ++py)
+		{
+			for (int px{ pMin.x }; px <= pMax.x; ++px)
+			{
+				const Vector2 pixel{ float(px), float(py) };
 
-						m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-							static_cast<uint8_t>(finalColor.r * 255),
-							static_cast<uint8_t>(finalColor.g * 255),
-							static_cast<uint8_t>(finalColor.b * 255));
-					}
-				}
+				const Vector2 vertex0ToPixel{ Vector2(vertex0.position.x, vertex0.position.y), pixel };
+				const float crossA{ Vector2::Cross(edgeA, vertex0ToPixel) };
+
+				const Vector2 vertex1ToPixel{ Vector2(vertex1.position.x, vertex1.position.y), pixel };
+				const float crossB{ Vector2::Cross(edgeB, vertex1ToPixel) };
+
+				const Vector2 vertex2ToPixel{ Vector2(vertex2.position.x, vertex2.position.y), pixel };
+				const float crossC{ Vector2::Cross(edgeC, vertex2ToPixel) };
+
+				//if pixel is inside triangle
+				if (crossA <= 0 || crossB <= 0 || crossC <= 0)
+					continue;
+
+				const float W0{ crossB / totalArea };
+				const float W1{ crossC / totalArea };
+				const float W2{ crossA / totalArea };
+
+				const float pixelDepth{ vertex0.position.z * W0 + vertex1.position.z * W1 + vertex2.position.z * W2 };
+
+				if (!m_pDepthBuffer->TestAndWrite(py * m_Width + px, pixelDepth))
+					continue;
+
+				const ColorRGB finalColor{ vertex0.color * W0 + vertex1.color * W1 + vertex2.color * W2 };
+
+				//Update Color in Buffer
+				m_pBackBufferPixels[px + (py * m_Width)] = m_PixelPacker.Pack(finalColor);
 			}
 		}
 	}
@@ -292,110 +684,16 @@ void Renderer::Render_W2_Part2TriangleStrip()
 		}
 	};
 
+	AssembleTriangles(vertices_world[0]);
+
 	std::vector<Vertex> vertices_ScreenSpace;
 	vertices_ScreenSpace.reserve(vertices_world[0].vertices.size());
 
 	VertexTransformationFunction(vertices_world, vertices_ScreenSpace);
 
-	std::fill_n(m_pDepthBufferPixels, m_Width * m_Height, FLT_MAX);
-	SDL_FillRect(m_pBackBuffer, NULL, SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100));
-
-	//std::cout << vertices_world[0].indices.size() << '\n';
-
-	//for each triangle
-	for (int index{}; index < vertices_world[0].indices.size() - 2; ++index)
-	{
-		Vertex vertex0{}, vertex1{}, vertex2{};
-
-		if (index % 2 == 0)
-		{
-			vertex0 = vertices_ScreenSpace[vertices_world[0].indices[index]];
-			vertex1 = vertices_ScreenSpace[vertices_world[0].indices[index + 1]];
-			vertex2 = vertices_ScreenSpace[vertices_world[0].indices[index + 2]];
-		}
-		else
-		{
-			vertex0 = vertices_ScreenSpace[vertices_world[0].indices[index]];
-			vertex1 = vertices_ScreenSpace[vertices_world[0].indices[index + 2]];
-			vertex2 = vertices_ScreenSpace[vertices_world[0].indices[index + 1]];
-		}
+	m_FrameClearers[m_DrawBuffer].ClearAll(m_PixelPacker.Pack(100, 100, 100));
 
-		//triangle edges
-		Vector2 edgeA{ Vector2(vertex0.position.x, vertex0.position.y),
-					   Vector2(vertex1.position.x, vertex1.position.y) };
-		Vector2 edgeB{ Vector2(vertex1.position.x, vertex1.position.y),
-					   Vector2(vertex2.position.x, vertex2.position.y) };
-		Vector2 edgeC{ Vector2(vertex2.position.x, vertex2.position.y),
-					   Vector2(vertex0.position.x, vertex0.position.y) };
-
-		float smallestX{ vertex0.position.x };
-		smallestX = std::min(smallestX, vertex1.position.x);
-		smallestX = std::min(smallestX, vertex2.position.x);
-
-		float smallestY{ vertex0.position.y };
-		smallestY = std::min(smallestY, vertex1.position.y);
-		smallestY = std::min(smallestY, vertex2.position.y);
-
-		float largestX{ vertex0.position.x };
-		largestX = std::max(largestX, vertex1.position.x);
-		largestX = std::max(largestX, vertex2.position.x);
-
-		float largestY{ vertex0.position.y };
-		largestY = std::max(largestY, vertex1.position.y);
-		largestY = std::max(largestY, vertex2.position.y);
-
-		Int2 pMin, pMax;
-		pMin.x = Clamp(int(smallestX), 0, m_Width);
-		pMin.y = Clamp(int(smallestY), 0, m_Height);
-		pMax.x = Clamp(int(largestX), 0, m_Width);
-		pMax.y = Clamp(int(largestY), 0, m_Height);
-
-		//for every pixel
-		for (int px{ pMin.x }; px <= pMax.x; ++px)
-		{
-			for (int py{ pMin.y }; py <= pMax.y; ++py)
-			{
-				const Vector2 pixel{ float(px), float(py) };
-
-				Vector2 vertex0ToPixel{ Vector2(vertex0.position.x, vertex0.position.y), pixel };
-				float crossA = Vector2::Cross(edgeA, vertex0ToPixel);
-
-				Vector2 vertex1ToPixel{ Vector2(vertex1.position.x, vertex1.position.y), pixel };
-				float crossB = Vector2::Cross(edgeB, vertex1ToPixel);
-
-				Vector2 vertex2ToPixel{ Vector2(vertex2.position.x, vertex2.position.y), pixel };
-				float crossC = Vector2::Cross(edgeC, vertex2ToPixel);
-
-				ColorRGB finalColor{};
-
-				//if pixel is inside triangle
-				if (crossA > 0 && crossB > 0 && crossC > 0)
-				{
-					const float totalArea = Vector2::Cross(edgeA, edgeB);
-					const float W0{ Vector2::Cross(edgeB, vertex1ToPixel) / totalArea };
-					const float W1{ Vector2::Cross(edgeC, vertex2ToPixel) / totalArea };
-					const float W2{ Vector2::Cross(edgeA, vertex0ToPixel) / totalArea };
-
-					const float pixelDepth = vertex0.position.z * W0 + vertex1.position.z * W1 + vertex2.position.z * W2;
-
-					if (pixelDepth < m_pDepthBufferPixels[py * m_Width + px])
-					{
-						m_pDepthBufferPixels[py * m_Width + px] = pixelDepth;
-
-						finalColor = vertex0.color * W0 + vertex1.color * W1 + vertex2.color * W2;
-
-						//Update Color in Buffer
-						finalColor.MaxToOne();
-
-						m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-							static_cast<uint8_t>(finalColor.r * 255),
-							static_cast<uint8_t>(finalColor.g * 255),
-							static_cast<uint8_t>(finalColor.b * 255));
-					}
-				}
-			}
-		}
-	}
+	RasterizeMesh(vertices_world[0], vertices_ScreenSpace);
 }
 
 void Renderer::Render_W2_Part2TriangleList()
@@ -424,332 +722,93 @@ void Renderer::Render_W2_Part2TriangleList()
 		}
 	};
 
+	AssembleTriangles(vertices_world[0]);
+
 	std::vector<Vertex> vertices_ScreenSpace;
 	vertices_ScreenSpace.reserve(vertices_world[0].vertices.size());
 
 	VertexTransformationFunction(vertices_world, vertices_ScreenSpace);
 
-	std::fill_n(m_pDepthBufferPixels, m_Width * m_Height, FLT_MAX);
-	SDL_FillRect(m_pBackBuffer, NULL, SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100));
-
-
-	//for each triangle
-	for (int index{}; index < vertices_world[0].indices.size(); index += 3)
-	{
-
-		Vertex vertex0{ vertices_ScreenSpace[vertices_world[0].indices[index]] };
-		Vertex vertex1{ vertices_ScreenSpace[vertices_world[0].indices[index + 1]] };
-		Vertex vertex2{ vertices_ScreenSpace[vertices_world[0].indices[index + 2]] };
-
-		//triangle edges
-		Vector2 edgeA{ Vector2(vertex0.position.x, vertex0.position.y),
-					   Vector2(vertex1.position.x, vertex1.position.y) };
-		Vector2 edgeB{ Vector2(vertex1.position.x, vertex1.position.y),
-					   Vector2(vertex2.position.x, vertex2.position.y) };
-		Vector2 edgeC{ Vector2(vertex2.position.x, vertex2.position.y),
-					   Vector2(vertex0.position.x, vertex0.position.y) };
-
-		float smallestX{ vertex0.position.x };
-		smallestX = std::min(smallestX, vertex1.position.x);
-		smallestX = std::min(smallestX, vertex2.position.x);
-
-		float smallestY{ vertex0.position.y };
-		smallestY = std::min(smallestY, vertex1.position.y);
-		smallestY = std::min(smallestY, vertex2.position.y);
-
-		float largestX{ vertex0.position.x };
-		largestX = std::max(largestX, vertex1.position.x);
-		largestX = std::max(largestX, vertex2.position.x);
+	m_FrameClearers[m_DrawBuffer].ClearAll(m_PixelPacker.Pack(100, 100, 100));
 
-		float largestY{ vertex0.position.y };
-		largestY = std::max(largestY, vertex1.position.y);
-		largestY = std::max(largestY, vertex2.position.y);
-
-		Int2 pMin, pMax;
-		pMin.x = Clamp(int(smallestX), 0, m_Width);
-		pMin.y = Clamp(int(smallestY), 0, m_Height);
-		pMax.x = Clamp(int(largestX), 0, m_Width);
-		pMax.y = Clamp(int(largestY), 0, m_Height);
-
-		//for every pixel
-		for (int px{ pMin.x }; px <= pMax.x; ++px)
-		{
-			for (int py{ pMin.y }; py <= pMax.y; ++py)
-			{
-				const Vector2 pixel{ float(px), float(py) };
-
-				Vector2 vertex0ToPixel{ Vector2(vertex0.position.x, vertex0.position.y), pixel };
-				float crossA = Vector2::Cross(edgeA, vertex0ToPixel);
-
-				Vector2 vertex1ToPixel{ Vector2(vertex1.position.x, vertex1.position.y), pixel };
-				float crossB = Vector2::Cross(edgeB, vertex1ToPixel);
-
-				Vector2 vertex2ToPixel{ Vector2(vertex2.position.x, vertex2.position.y), pixel };
-				float crossC = Vector2::Cross(edgeC, vertex2ToPixel);
-
-				ColorRGB finalColor{};
-
-				//if pixel is inside triangle
-				if (crossA > 0 && crossB > 0 && crossC > 0)
-				{
-					const float totalArea = Vector2::Cross(edgeA, edgeB);
-					const float W0{ Vector2::Cross(edgeB, vertex1ToPixel) / totalArea };
-					const float W1{ Vector2::Cross(edgeC, vertex2ToPixel) / totalArea };
-					const float W2{ Vector2::Cross(edgeA, vertex0ToPixel) / totalArea };
-
-					const float pixelDepth = vertex0.position.z * W0 + vertex1.position.z * W1 + vertex2.position.z * W2;
-
-					if (pixelDepth < m_pDepthBufferPixels[py * m_Width + px])
-					{
-						m_pDepthBufferPixels[py * m_Width + px] = pixelDepth;
-
-						finalColor = vertex0.color * W0 + vertex1.color * W1 + vertex2.color * W2;
-
-						//Update Color in Buffer
-						finalColor.MaxToOne();
-
-						m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-							static_cast<uint8_t>(finalColor.r * 255),
-							static_cast<uint8_t>(finalColor.g * 255),
-							static_cast<uint8_t>(finalColor.b * 255));
-					}
-				}
-			}
-		}
-	}
+	RasterizeMesh(vertices_world[0], vertices_ScreenSpace);
 }
 
 void Renderer::Render_W2_Part1()
 {
 	//Define Quad - Vertices in World space
-	std::vector<Vertex> vertices_world
+	Mesh quad
 	{
-		{{-3.f, 3.f, -2.f}, {1, 1, 1}},
-		{{0.f, 3.f, -2.f}, {1, 1, 1}},
-		{{3.f, 3.f, -2.f}, {1, 1, 1}},
-		{{-3.f, 0.f, -2.f}, {1, 1, 1}},
-		{{0.f, 0.f, -2.f}, {1, 1, 1}},
-		{{3.f, 0.f, -2.f}, {1, 1, 1}},
-		{{-3.f, -3.f, -2.f}, {1, 1, 1}},
-		{{0.f, -3.f, -2.f}, {1, 1, 1}},
-		{{3.f, -3.f, -2.f}, {1, 1, 1}}
+		{
+			{{-3.f, 3.f, -2.f}, {1, 1, 1}},
+			{{0.f, 3.f, -2.f}, {1, 1, 1}},
+			{{3.f, 3.f, -2.f}, {1, 1, 1}},
+			{{-3.f, 0.f, -2.f}, {1, 1, 1}},
+			{{0.f, 0.f, -2.f}, {1, 1, 1}},
+			{{3.f, 0.f, -2.f}, {1, 1, 1}},
+			{{-3.f, -3.f, -2.f}, {1, 1, 1}},
+			{{0.f, -3.f, -2.f}, {1, 1, 1}},
+			{{3.f, -3.f, -2.f}, {1, 1, 1}}
+		},
+		{
+			3, 0, 4,
+			0, 1, 4,
+			4, 1, 5,
+			1, 2, 5,
+			6, 3, 7,
+			3, 4, 7,
+			7, 4, 8,
+			4, 5, 8
+		},
+		PrimitiveTopology::TriangeList
 	};
 
-	std::vector<int> indices_quad
-	{
-		3, 0, 4,
-		0, 1, 4,
-		4, 1, 5,
-		1, 2, 5,
-		6, 3, 7,
-		3, 4, 7,
-		7, 4, 8,
-		4, 5, 8
-	};
+	AssembleTriangles(quad);
 
 	std::vector<Vertex> vertices_ScreenSpace;
-	vertices_ScreenSpace.reserve(vertices_world.size());
-
-	VertexTransformationFunction(vertices_world, vertices_ScreenSpace);
-
-	std::fill_n(m_pDepthBufferPixels, m_Width * m_Height, FLT_MAX);
-	SDL_FillRect(m_pBackBuffer, NULL, SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100));
+	vertices_ScreenSpace.reserve(quad.vertices.size());
 
+	VertexTransformationFunction(quad.vertices, vertices_ScreenSpace);
 
-	//for each triangle
-	for (int index{}; index < indices_quad.size(); index += 3)
-	{
-		
-		Vertex vertex0{ vertices_ScreenSpace[indices_quad[index]] };
-		Vertex vertex1{ vertices_ScreenSpace[indices_quad[index + 1]] };
-		Vertex vertex2{ vertices_ScreenSpace[indices_quad[index + 2]] };
-
-		//triangle edges
-		Vector2 edgeA{ Vector2(vertex0.position.x, vertex0.position.y),
-					   Vector2(vertex1.position.x, vertex1.position.y) };
-		Vector2 edgeB{ Vector2(vertex1.position.x, vertex1.position.y),
-					   Vector2(vertex2.position.x, vertex2.position.y) };
-		Vector2 edgeC{ Vector2(vertex2.position.x, vertex2.position.y),
-					   Vector2(vertex0.position.x, vertex0.position.y) };
-
-		float smallestX{ vertex0.position.x };
-		smallestX = std::min(smallestX, vertex1.position.x);
-		smallestX = std::min(smallestX, vertex2.position.x);
+	m_FrameClearers[m_DrawBuffer].ClearAll(m_PixelPacker.Pack(100, 100, 100));
 
-		float smallestY{ vertex0.position.y };
-		smallestY = std::min(smallestY, vertex1.position.y);
-		smallestY = std::min(smallestY, vertex2.position.y);
-
-		float largestX{ vertex0.position.x };
-		largestX = std::max(largestX, vertex1.position.x);
-		largestX = std::max(largestX, vertex2.position.x);
-
-		float largestY{vertex0.position.y };
-		largestY = std::max(largestY,vertex1.position.y);
-		largestY = std::max(largestY, vertex2.position.y);
-
-		Int2 pMin, pMax;
-		pMin.x = Clamp(int(smallestX), 0, m_Width);
-		pMin.y = Clamp(int(smallestY), 0, m_Height);
-		pMax.x = Clamp(int(largestX), 0, m_Width);
-		pMax.y = Clamp(int(largestY), 0, m_Height);
-
-		//for every pixel
-		for (int px{ pMin.x }; px <= pMax.x; ++px)
-		{
-			for (int py{ pMin.y }; py <= pMax.y; ++py)
-			{
-				const Vector2 pixel{ float(px), float(py) };
-
-				Vector2 vertex0ToPixel{ Vector2(vertex0.position.x, vertex0.position.y), pixel };
-				float crossA = Vector2::Cross(edgeA, vertex0ToPixel);
-
-				Vector2 vertex1ToPixel{ Vector2(vertex1.position.x, vertex1.position.y), pixel };
-				float crossB = Vector2::Cross(edgeB, vertex1ToPixel);
-
-				Vector2 vertex2ToPixel{ Vector2(vertex2.position.x, vertex2.position.y), pixel };
-				float crossC = Vector2::Cross(edgeC, vertex2ToPixel);
-
-				ColorRGB finalColor{};
-
-				//if pixel is inside triangle
-				if (crossA > 0 && crossB > 0 && crossC > 0)
-				{
-					const float totalArea = Vector2::Cross(edgeA, edgeB);
-					const float W0{ Vector2::Cross(edgeB, vertex1ToPixel) / totalArea };
-					const float W1{ Vector2::Cross(edgeC, vertex2ToPixel) / totalArea };
-					const float W2{ Vector2::Cross(edgeA, vertex0ToPixel) / totalArea };
-
-					const float pixelDepth = vertex0.position.z * W0 + vertex1.position.z * W1 + vertex2.position.z * W2;
-
-					if (pixelDepth < m_pDepthBufferPixels[py * m_Width + px])
-					{
-						m_pDepthBufferPixels[py * m_Width + px] = pixelDepth;
-
-						finalColor = vertex0.color * W0 + vertex1.color * W1 + vertex2.color * W2;
-
-						//Update Color in Buffer
-						finalColor.MaxToOne();
-
-						m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-							static_cast<uint8_t>(finalColor.r * 255),
-							static_cast<uint8_t>(finalColor.g * 255),
-							static_cast<uint8_t>(finalColor.b * 255));
-					}
-				}
-			}
-		}
-	}
+	RasterizeMesh(quad, vertices_ScreenSpace);
 }
 
 
 void Renderer::Render_W1_Part5()
 {
 	//Define Triangle - Vertices in World space
-	std::vector<Vertex> vertices_world
-	{
-		//Triangle 0
-		{{0.f, 2.f, 0.f}, {1, 0, 0}},
-		{{1.5f, -1.f, 0.f}, {1, 0, 0}},
-		{{-1.5f, -1.f, 0.f}, {1, 0, 0}},
-
-		//Triangle 1
-		{{0.f, 4.f, 2.f}, {1, 0, 0}},
-		{{3.f, -2.f, 2.f}, {0, 1, 0}},
-		{{-3.f, -2.f, 2.f}, {0, 0, 1}}
-	};
-
-	std::vector<Vertex> vertices_ScreenSpace;
-	vertices_ScreenSpace.reserve(vertices_world.size());
-
-	VertexTransformationFunction(vertices_world, vertices_ScreenSpace);
-
-	std::fill_n(m_pDepthBufferPixels, m_Width * m_Height, FLT_MAX);
-	SDL_FillRect(m_pBackBuffer, NULL, SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100));
-
-	//for each triangle
-	for (int index{}; index < vertices_ScreenSpace.size(); index += 3)
+	Mesh triangles
 	{
-		Vertex vertex0{ vertices_ScreenSpace[index] };
-		Vertex vertex1{ vertices_ScreenSpace[index + 1] };
-		Vertex vertex2{ vertices_ScreenSpace[index + 2] };
-
-		//check if pixel is inside triangle
-		Vector2 edgeA{ Vector2(vertex0.position.x, vertex0.position.y),
-					   Vector2(vertex1.position.x, vertex1.position.y) };
-		Vector2 edgeB{ Vector2(vertex1.position.x, vertex1.position.y),
-					   Vector2(vertex2.position.x, vertex2.position.y) };
-		Vector2 edgeC{ Vector2(vertex2.position.x, vertex2.position.y),
-					   Vector2(vertex0.position.x, vertex0.position.y) };
-
-		float smallestX{ vertex0.position.x };
-		smallestX = std::min(smallestX, vertex1.position.x);
-		smallestX = std::min(smallestX, vertex2.position.x);
-
-		float smallestY{ vertex0.position.y };
-		smallestY = std::min(smallestY, vertex1.position.y);
-		smallestY = std::min(smallestY, vertex2.position.y);
-
-		float largestX{ vertex0.position.x };
-		largestX = std::max(largestX, vertex1.position.x);
-		largestX = std::max(largestX, vertex2.position.x);
-
-		float largestY{ vertex0.position.y };
-		largestY = std::max(largestY, vertex1.position.y);
-		largestY = std::max(largestY, vertex2.position.y);
-
-		Int2 pMin, pMax;
-		pMin.x = Clamp(int(smallestX), 0, m_Width);
-		pMin.y = Clamp(int(smallestY), 0, m_Height);
-		pMax.x = Clamp(int(largestX), 0, m_Width);
-		pMax.y = Clamp(int(largestY), 0, m_Height);
-
-		//for every pixel
-		for (int py{ pMin.y }; py <= pMax.y; ++py)
 		{
-			for (int px{ pMin.x }; px <= pMax.x; ++px)
-			{
-				const Vector2 pixel{ float(px), float(py) };
-
-				Vector2 vertex0ToPixel{ Vector2(vertex0.position.x, vertex0.position.y), pixel };
-				float crossA = Vector2::Cross(edgeA, vertex0ToPixel);
-
-				Vector2 vertex1ToPixel{ Vector2(vertex1.position.x, vertex1.position.y), pixel };
-				float crossB = Vector2::Cross(edgeB, vertex1ToPixel);
-
-				Vector2 vertex2ToPixel{ Vector2(vertex2.position.x, vertex2.position.y), pixel };
-				float crossC = Vector2::Cross(edgeC, vertex2ToPixel);
-
-				ColorRGB finalColor{};
-
-				//if pixel is inside triangle
-				if (crossA > 0 && crossB > 0 && crossC > 0)
-				{
-					const float totalArea = Vector2::Cross(edgeA, edgeB);
-					const float W0{ Vector2::Cross(edgeB, vertex1ToPixel) / totalArea };
-					const float W1{ Vector2::Cross(edgeC, vertex2ToPixel) / totalArea };
-					const float W2{ Vector2::Cross(edgeA, vertex0ToPixel) / totalArea };
+			//Triangle 0
+			{{0.f, 2.f, 0.f}, {1, 0, 0}},
+			{{1.5f, -1.f, 0.f}, {1, 0, 0}},
+			{{-1.5f, -1.f, 0.f}, {1, 0, 0}},
+
+			//Triangle 1
+			{{0.f, 4.f, 2.f}, {1, 0, 0}},
+			{{3.f, -2.f, 2.f}, {0, 1, 0}},
+			{{-3.f, -2.f, 2.f}, {0, 0, 1}}
+		},
+		{
+			0, 1, 2,
+			3, 4, 5
+		},
+		PrimitiveTopology::TriangeList
+	};
 
-					const float pixelDepth = vertex0.position.z * W0 + vertex1.position.z * W1 + vertex2.position.z * W2;
+	AssembleTriangles(triangles);
 
-					if (pixelDepth < m_pDepthBufferPixels[py * m_Width + px])
-					{
-						m_pDepthBufferPixels[py * m_Width + px] = pixelDepth;
+	std::vector<Vertex> vertices_ScreenSpace;
+	vertices_ScreenSpace.reserve(triangles.vertices.size());
 
-						finalColor = vertex0.color * W0 + vertex1.color * W1 + vertex2.color * W2;
+	VertexTransformationFunction(triangles.vertices, vertices_ScreenSpace);
 
-						//Update Color in Buffer
-						finalColor.MaxToOne();
+	m_FrameClearers[m_DrawBuffer].ClearAll(m_PixelPacker.Pack(100, 100, 100));
 
-						m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-							static_cast<uint8_t>(finalColor.r * 255),
-							static_cast<uint8_t>(finalColor.g * 255),
-							static_cast<uint8_t>(finalColor.b * 255));
-					}
-				}
-			}
-		}
-	}
+	RasterizeMesh(triangles, vertices_ScreenSpace);
 }
 
 void Renderer::Render_W1_Part4()
@@ -773,8 +832,7 @@ void Renderer::Render_W1_Part4()
 
 	VertexTransformationFunction(vertices_world, vertices_ScreenSpace);
 
-	std::fill_n(m_pDepthBufferPixels, m_Width * m_Height, FLT_MAX);
-	SDL_FillRect(m_pBackBuffer, NULL, SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100));
+	m_FrameClearers[m_DrawBuffer].ClearAll(m_PixelPacker.Pack(100, 100, 100));
 
 	const int vertexSet{ 3 };
 	const int triangleAmount{ int(vertices_ScreenSpace.size()) / 3 };
@@ -821,20 +879,14 @@ void Renderer::Render_W1_Part4()
 					const float pixelDepth = vertices_ScreenSpace[triangleIndex + 0].position.z * W0 + vertices_ScreenSpace[triangleIndex + 1].position.z * W1 
 											+ vertices_ScreenSpace[triangleIndex + 2].position.z * W2;
 
-					if (pixelDepth < m_pDepthBufferPixels[py * m_Width + px])
+					if (m_pDepthBuffer->TestAndWrite(py * m_Width + px, pixelDepth))
 					{
-						m_pDepthBufferPixels[py * m_Width + px] = pixelDepth;
 						
 						finalColor = vertices_ScreenSpace[triangleIndex + 0].color * W0 + vertices_ScreenSpace[triangleIndex + 1].color * W1
 							+ vertices_ScreenSpace[triangleIndex + 2].color * W2;
 
 						//Update Color in Buffer
-						finalColor.MaxToOne();
-
-						m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-							static_cast<uint8_t>(finalColor.r * 255),
-							static_cast<uint8_t>(finalColor.g * 255),
-							static_cast<uint8_t>(finalColor.b * 255));
+						m_pBackBufferPixels[px + (py * m_Width)] = m_PixelPacker.Pack(finalColor);
 					}
 				}
 			}
@@ -903,12 +955,7 @@ void Renderer::Render_W1_Part3()
 			}
 
 			//Update Color in Buffer
-			finalColor.MaxToOne();
-
-			m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-				static_cast<uint8_t>(finalColor.r * 255),
-				static_cast<uint8_t>(finalColor.g * 255),
-				static_cast<uint8_t>(finalColor.b * 255));
+			m_pBackBufferPixels[px + (py * m_Width)] = m_PixelPacker.Pack(finalColor);
 		}
 	}
 }
@@ -960,12 +1007,7 @@ void Renderer::Render_W1_Part2()
 			}
 
 			//Update Color in Buffer
-			finalColor.MaxToOne();
-
-			m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-				static_cast<uint8_t>(finalColor.r * 255),
-				static_cast<uint8_t>(finalColor.g * 255),
-				static_cast<uint8_t>(finalColor.b * 255));
+			m_pBackBufferPixels[px + (py * m_Width)] = m_PixelPacker.Pack(finalColor);
 		}
 	}
 }
@@ -1012,12 +1054,7 @@ void Renderer::Render_W1_Part1()
 			}
 
 			//Update Color in Buffer
-			finalColor.MaxToOne();
-
-			m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-				static_cast<uint8_t>(finalColor.r * 255),
-				static_cast<uint8_t>(finalColor.g * 255),
-				static_cast<uint8_t>(finalColor.b * 255));
+			m_pBackBufferPixels[px + (py * m_Width)] = m_PixelPacker.Pack(finalColor);
 		}
 	}
 }
\ No newline at end of file
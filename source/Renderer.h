@@ -1,10 +1,16 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "Camera.h"
 #include "DataTypes.h"
+#include "DepthBuffer.h"
+#include "FrameClearer.h"
+#include "PixelPacker.h"
+#include "TileBinner.h"
 
 struct SDL_Window;
 struct SDL_Surface;
@@ -12,15 +18,22 @@ struct SDL_Surface;
 namespace dae
 {
 	class Texture;
-	struct Mesh;
-	struct Vertex;
+	class TextureHandle;
+	class TextureLoader;
+	class TextureManager;
+	class PipelineStage;
+	class JobSystem;
+	class FrameArena;
 	class Timer;
 	class Scene;
 
 	class Renderer final
 	{
 	public:
-		Renderer(SDL_Window* pWindow);
+		//0 workers picks one less than the hardware threads, pinned workers each stay on one core
+		Renderer(SDL_Window* pWindow, uint32_t workerCount = 0, bool isPinned = false);
+		//Headless, renders into its own buffers without a window or SDL video
+		Renderer(int width, int height, uint32_t workerCount = 0, bool isPinned = false);
 		~Renderer();
 
 		Renderer(const Renderer&) = delete;
@@ -40,26 +53,114 @@ namespace dae
 		void Render_W2_Part2TriangleList();
 		void Render_W2_UVCoordinates();
 
+		//Recreates the depth buffer, from the next frame on
+		void SetDepthFormat(DepthFormat format, bool isReversed);
+		DepthFormat GetDepthFormat() const { return m_pDepthBuffer->GetFormat(); }
+		bool IsDepthReversed() const { return m_pDepthBuffer->IsReversed(); }
+
+		//Update prepares camera and geometry of a frame while Render rasterizes and presents the previous one,
+		//so a frame shows up one Render later. The camera belongs to the geometry stage from Update until Render returns
+		void SetFramePipelining(bool isPipelined);
+		bool IsFramePipelined() const { return m_pGeometryStage != nullptr; }
+
+		//True when saving failed, it passes on the error code of SDL_SaveBMP
 		bool SaveBufferToImage() const;
+		bool SaveBufferToImage(const std::string& path) const;
+
+		//Blocks until every texture finished loading, returns how many failed and would render as a placeholder
+		uint32_t WaitForTextures();
+
+		bool IsHeadless() const { return m_pWindow == nullptr; }
+		int GetWidth() const { return m_Width; }
+		int GetHeight() const { return m_Height; }
+		//Packed pixels in the back buffer's format, valid after Render
+		const uint32_t* GetPixels() const { return m_pBackBufferPixels; }
+		SDL_Surface* GetBackBuffer() const { return m_pBackBuffer; }
+		Camera& GetCamera() { return m_Camera; }
+		JobSystem& GetJobSystem() const { return *m_pJobSystem; }
+		const FrameArena& GetFrameArena() const { return *m_pFrameArena; }
 
 	private:
 		SDL_Window* m_pWindow{};
 
 		SDL_Surface* m_pFrontBuffer{ nullptr };
+		//The one drawn into, and after Render the finished frame
 		SDL_Surface* m_pBackBuffer{ nullptr };
 		uint32_t* m_pBackBufferPixels{};
+		SDL_Surface* m_pBackBuffers[2]{};
+		int m_BackBufferCount{};
+		int m_DrawBuffer{};
+		PipelineStage* m_pPresentStage{ nullptr };
+		bool m_IsPresentPending{ false };
+		uint32_t* m_pHeadlessPixels{ nullptr };
+		PixelPacker m_PixelPacker{};
 
-		float* m_pDepthBufferPixels{};
+		JobSystem* m_pJobSystem{ nullptr };
+		//Transient data of the frame on the render thread, and scratch of the vertex transform on whichever thread runs it
+		FrameArena* m_pFrameArena{ nullptr };
+		FrameArena* m_pGeometryArena{ nullptr };
+		DepthBuffer* m_pDepthBuffer{ nullptr };
+		FrameClearer m_FrameClearers[2]{};
+
+		//Set up once per triangle, then rasterized by every tile it was binned into, two cache lines
+		struct alignas(64) RasterTriangle
+		{
+			Vector3 position0{};
+			Vector3 position1{};
+			Vector3 position2{};
+			Vector2 uv0{};
+			Vector2 uv1{};
+			Vector2 uv2{};
+			Vector2 edgeA{};
+			Vector2 edgeB{};
+			Vector2 edgeC{};
+			Vector2 invZGradient{};
+			Vector2 uOverZGradient{};
+			Vector2 vOverZGradient{};
+			Int2 pMin{};
+			Int2 pMax{};
+		};
+		static_assert(sizeof(RasterTriangle) == 128);
+		TileBinner m_TileBinner{};
 
 		Camera m_Camera{};
 
 		int m_Width{};
 		int m_Height{};
 
-		Texture* m_pTexture;
+		TextureLoader* m_pTextureLoader{ nullptr };
+		//Shared by the process, not owned, the application updates it once per frame
+		TextureManager* m_pTextureManager{ nullptr };
+		std::shared_ptr<TextureHandle> m_pTexture{};
+
+		std::vector<Mesh> m_Meshes{};
+		//Rasterized from one while the geometry stage transforms into the other
+		std::vector<VertexPosition> m_ScreenSpacePositions[2]{};
+		int m_RasterBuffer{};
+		PipelineStage* m_pGeometryStage{ nullptr };
+		bool m_IsGeometryPending{ false };
+		bool m_HasRasterGeometry{ false };
+
+		void Initialize(uint32_t workerCount, bool isPinned);
+		void UpdateCamera(Timer* pTimer);
+		void FinishGeometry();
+		void TransformGeometry(std::vector<VertexPosition>& positions_ScreenSpace) const;
+		void RasterizeUVCoordinates(const std::vector<VertexPosition>& positions_ScreenSpace);
+		//Only the pixels within the inclusive bounds, one tile's part of the triangle
+		void RasterizeTriangle(const RasterTriangle& triangle, const Texture& texture, const Int2& pMin, const Int2& pMax);
+
+		//Rasterizes the assembled triangles of a mesh already transformed to screen space with vertex colors
+		//Textured meshes go through RasterizeUVCoordinates, which bins and shades in spans
+		void RasterizeMesh(const Mesh& mesh, const std::vector<Vertex>& vertices_ScreenSpace);
 
 		//Function that transforms the vertices from the mesh from World space to Screen space
 		void VertexTransformationFunction(const std::vector<Vertex>& vertices_in, std::vector<Vertex>& vertices_out) const; //W1 Version
 		void VertexTransformationFunction(const std::vector<Mesh>& vertices_in, std::vector<Vertex>& vertices_out) const;
+		//Only the position stream, for paths that read the attribute stream from the meshes
+		void VertexTransformationFunction(const std::vector<Mesh>& meshes_in, std::vector<VertexPosition>& positions_out) const;
+		//Prefix sum of the mesh sizes, then chunks of vertices in parallel
+		template<typename Output, typename CountVertices, typename TransformVertex>
+		void TransformMeshes(const std::vector<Mesh>& meshes_in, std::vector<Output>& out, CountVertices&& countVertices, TransformVertex&& transformVertex) const;
+		Vector3 TransformToScreen(const Vector3& worldPosition, float aspectRatio) const;
 	};
 }
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <emmintrin.h>
+#include <type_traits>
+
+namespace dae
+{
+	//Fills count values, scalar until 16 byte aligned, the bulk with non-temporal stores that bypass the cache
+	//Call _mm_sfence once all fills are done, before anything reads the memory
+	template<typename Value>
+	void StreamFill(Value* pDestination, size_t count, Value value)
+	{
+		static_assert(sizeof(Value) == 2 || sizeof(Value) == 4, "Values are streamed 16 bytes at a time");
+		constexpr size_t valuesPerStore{ 16 / sizeof(Value) };
+
+		for (; count > 0 && (reinterpret_cast<uintptr_t>(pDestination) & 15) != 0; --count)
+			*pDestination++ = value;
+
+		if constexpr (std::is_same_v<Value, float>)
+		{
+			const __m128 values{ _mm_set1_ps(value) };
+			for (; count >= valuesPerStore; count -= valuesPerStore, pDestination += valuesPerStore)
+				_mm_stream_ps(pDestination, values);
+		}
+		else
+		{
+			const __m128i values{ sizeof(Value) == 2 ? _mm_set1_epi16(short(value)) : _mm_set1_epi32(int(value)) };
+			for (; count >= valuesPerStore; count -= valuesPerStore, pDestination += valuesPerStore)
+				_mm_stream_si128(reinterpret_cast<__m128i*>(pDestination), values);
+		}
+
+		for (; count > 0; --count)
+			*pDestination++ = value;
+	}
+}
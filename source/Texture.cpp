@@ -1,50 +1,896 @@
 #include "Texture.h"
+#include "ColorSpace.h"
 #include "Vector2.h"
 #include <SDL_image.h>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <emmintrin.h>
 
 namespace dae
 {
-	Texture::Texture(SDL_Surface* pSurface) :
-		m_pSurface{ pSurface },
-		m_pSurfacePixels{ (uint32_t*)pSurface->pixels }
+	namespace
 	{
+		//Byte to [0, 1] float, so sampling never divides
+		const std::array<float, 256> g_ByteToFloat{ []()
+		{
+			std::array<float, 256> lut{};
+			for (size_t i{}; i < lut.size(); ++i)
+				lut[i] = float(i) / 255.f;
+			return lut;
+		}() };
+
+		//The table decodes either plain unorm bytes or sRGB encoded ones
+		ColorRGB Unpack(uint32_t texel, const float* pByteToFloat)
+		{
+			return ColorRGB{ pByteToFloat[texel & 0xFF], pByteToFloat[(texel >> 8) & 0xFF], pByteToFloat[(texel >> 16) & 0xFF] };
+		}
+
+		//Rounded average of four RGBA8 texels, per channel
+		uint32_t Average(uint32_t t0, uint32_t t1, uint32_t t2, uint32_t t3)
+		{
+			uint32_t result{};
+			for (uint32_t shift{}; shift < 32; shift += 8)
+			{
+				const uint32_t sum{ ((t0 >> shift) & 0xFF) + ((t1 >> shift) & 0xFF) + ((t2 >> shift) & 0xFF) + ((t3 >> shift) & 0xFF) };
+				result |= ((sum + 2) / 4) << shift;
+			}
+			return result;
+		}
+
+		//Average of four sRGB encoded texels in linear space, alpha is linear already
+		uint32_t AverageSRGB(uint32_t t0, uint32_t t1, uint32_t t2, uint32_t t3)
+		{
+			uint32_t result{ Average(t0, t1, t2, t3) & 0xFF000000 };
+			for (uint32_t shift{}; shift < 24; shift += 8)
+			{
+				const float sum{ ColorSpace::SRGBToLinear(uint8_t(t0 >> shift)) + ColorSpace::SRGBToLinear(uint8_t(t1 >> shift))
+					+ ColorSpace::SRGBToLinear(uint8_t(t2 >> shift)) + ColorSpace::SRGBToLinear(uint8_t(t3 >> shift)) };
+				result |= uint32_t(ColorSpace::LinearToSRGB(sum * .25f)) << shift;
+			}
+			return result;
+		}
+
+		//Spread the lower 16 bits so a zero bit sits between every pair
+		uint32_t SpreadBits(uint32_t value)
+		{
+			value &= 0x0000FFFF;
+			value = (value | (value << 8)) & 0x00FF00FF;
+			value = (value | (value << 4)) & 0x0F0F0F0F;
+			value = (value | (value << 2)) & 0x33333333;
+			value = (value | (value << 1)) & 0x55555555;
+			return value;
+		}
+
+		int CeilLog2(int value)
+		{
+			int bits{};
+			while ((1 << bits) < value)
+				++bits;
+			return bits;
+		}
+
+		//One channel of four RGBA8 texels as floats in [0, 255]
+		template<int shift>
+		__m128 UnpackChannel(__m128i texels)
+		{
+			return _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(texels, shift), _mm_set1_epi32(0xFF)));
+		}
+
+		//One channel of four sRGB encoded texels, decoded to linear [0, 1] through the table
+		template<int shift>
+		__m128 DecodeChannel(const uint32_t* pTexels)
+		{
+			return _mm_set_ps(ColorSpace::SRGBToLinear(uint8_t(pTexels[3] >> shift)), ColorSpace::SRGBToLinear(uint8_t(pTexels[2] >> shift)),
+				ColorSpace::SRGBToLinear(uint8_t(pTexels[1] >> shift)), ColorSpace::SRGBToLinear(uint8_t(pTexels[0] >> shift)));
+		}
+
+		bool IsPowerOfTwo(int value)
+		{
+			return value > 0 && (value & (value - 1)) == 0;
+		}
+
+		//Floor without a call into the CRT, the comparison corrects truncation of negative values
+		int FloorToInt(float value)
+		{
+			const int truncated{ int(value) };
+			return truncated - int(value < float(truncated));
+		}
+
+		__m128i FloorToInt(__m128 values)
+		{
+			const __m128i truncated{ _mm_cvttps_epi32(values) };
+			//The compare mask is -1 where truncation rounded up
+			return _mm_add_epi32(truncated, _mm_castps_si128(_mm_cmplt_ps(values, _mm_cvtepi32_ps(truncated))));
+		}
+
+		//Maps any integer texel coordinate into [0, size) without branching
+		template<AddressMode mode, bool isPowerOfTwo>
+		int AddressTexel(int coordinate, int size)
+		{
+			if constexpr (mode == AddressMode::Clamp)
+			{
+				return std::min(std::max(coordinate, 0), size - 1);
+			}
+			else if constexpr (mode == AddressMode::Wrap)
+			{
+				if constexpr (isPowerOfTwo)
+					return coordinate & (size - 1);
+
+				const int remainder{ coordinate % size };
+				return remainder + (size & (remainder >> 31));
+			}
+			else
+			{
+				//Mirror repeats every two sizes, the second half reads backwards
+				const int period{ size * 2 };
+				int wrapped{};
+				if constexpr (isPowerOfTwo)
+				{
+					wrapped = coordinate & (period - 1);
+				}
+				else
+				{
+					const int remainder{ coordinate % period };
+					wrapped = remainder + (period & (remainder >> 31));
+				}
+				return std::min(wrapped, period - 1 - wrapped);
+			}
+		}
+
+		//Decoded 4x4 blocks of compressed textures, per thread so sampling needs no locks
+		struct DecodedBlock
+		{
+			uint64_t key{ UINT64_MAX };
+			uint32_t texels[16]{};
+		};
+		thread_local std::array<DecodedBlock, 256> t_DecodedBlocks{};
+
+		std::atomic<uint32_t> g_NextTextureId{};
+		const std::atomic<uint32_t> g_UntrackedFrame{};
+
+		template<int tileBits>
+		size_t TiledIndex(int tilesPerRow, int x, int y)
+		{
+			constexpr int tileMask{ (1 << tileBits) - 1 };
+			const size_t tile{ size_t(y >> tileBits) * tilesPerRow + (x >> tileBits) };
+			return (tile << (tileBits * 2)) | (size_t(y & tileMask) << tileBits) | size_t(x & tileMask);
+		}
+	}
+
+	Texture::Texture(TexelLayout layout, TextureFormat format, TextureColorSpace colorSpace) :
+		m_pCurrentFrame{ &g_UntrackedFrame },
+		m_Layout{ format == TextureFormat::RGBA8 ? layout : TexelLayout::Linear },
+		m_Format{ format },
+		m_Id{ g_NextTextureId++ },
+		m_IsSRGB{ colorSpace == TextureColorSpace::SRGB },
+		m_pByteToFloat{ m_IsSRGB ? ColorSpace::g_SRGBToLinear.data() : g_ByteToFloat.data() }
+	{
+	}
+
+	Texture* Texture::LoadFromFile(const std::string& path, TexelLayout layout, TextureColorSpace colorSpace)
+	{
+		return Load(path, layout, TextureFormat::RGBA8, colorSpace);
+	}
+
+	Texture* Texture::LoadFromFile(const std::string& path, TextureFormat format)
+	{
+		return Load(path, TexelLayout::Linear, format, GetDefaultColorSpace(format));
+	}
+
+	Texture* Texture::LoadFromFile(const std::string& path, TextureFormat format, TextureColorSpace colorSpace)
+	{
+		return Load(path, TexelLayout::Linear, format, colorSpace);
+	}
+
+	Texture* Texture::CreateFromBlocks(TextureFormat format, int width, int height, const std::vector<uint8_t>& blocks)
+	{
+		return CreateFromBlocks(format, GetDefaultColorSpace(format), width, height, blocks);
+	}
+
+	Texture* Texture::CreateFromBlocks(TextureFormat format, TextureColorSpace colorSpace, int width, int height, const std::vector<uint8_t>& blocks)
+	{
+		const size_t blockSize{ BlockCompression::GetBlockSize(format) };
+		const int blocksPerRow{ (width + 3) / 4 };
+		const int blockRows{ (height + 3) / 4 };
+		const size_t baseLevelSize{ size_t(blocksPerRow) * blockRows * blockSize };
+		if (blockSize == 0 || width <= 0 || height <= 0 || blocks.size() < baseLevelSize || !IsValidColorSpace(format, colorSpace))
+			return nullptr;
+
+		Texture* pTexture{ new Texture(TexelLayout::Linear, format, colorSpace) };
+
+		//Smaller mips are filtered from the decoded base level
+		MipLevel& baseLevel{ pTexture->m_MipLevels.emplace_back() };
+		baseLevel.width = width;
+		baseLevel.height = height;
+		baseLevel.texels.resize(size_t(width) * height);
+
+		uint32_t blockTexels[16]{};
+		for (int blockY{}; blockY < blockRows; ++blockY)
+		{
+			for (int blockX{}; blockX < blocksPerRow; ++blockX)
+			{
+				BlockCompression::DecodeBlock(format, &blocks[(size_t(blockY) * blocksPerRow + blockX) * blockSize], blockTexels);
+
+				for (int y{ blockY * 4 }; y < std::min(blockY * 4 + 4, height); ++y)
+				{
+					for (int x{ blockX * 4 }; x < std::min(blockX * 4 + 4, width); ++x)
+						baseLevel.texels[x + (size_t(y) * width)] = blockTexels[(y & 3) * 4 + (x & 3)];
+				}
+			}
+		}
+
+		pTexture->Finalize();
+
+		//Keep the original base level, encoding it again would only lose quality
+		pTexture->m_MipLevels.front().blocks.assign(blocks.begin(), blocks.begin() + baseLevelSize);
+
+		return pTexture;
+	}
+
+	Texture* Texture::CreateSolid(const ColorRGB& color)
+	{
+		Texture* pTexture{ new Texture(TexelLayout::Linear, TextureFormat::RGBA8, TextureColorSpace::SRGB) };
+
+		MipLevel& baseLevel{ pTexture->m_MipLevels.emplace_back() };
+		baseLevel.width = 1;
+		baseLevel.height = 1;
+		baseLevel.texels.push_back(uint32_t(ColorSpace::LinearToSRGB(color.r))
+			| (uint32_t(ColorSpace::LinearToSRGB(color.g)) << 8)
+			| (uint32_t(ColorSpace::LinearToSRGB(color.b)) << 16)
+			| 0xFF000000u);
+
+		pTexture->Finalize();
+		return pTexture;
+	}
+
+	TextureColorSpace Texture::GetDefaultColorSpace(TextureFormat format)
+	{
+		return format == TextureFormat::BC5 ? TextureColorSpace::Linear : TextureColorSpace::SRGB;
+	}
+
+	bool Texture::IsValidColorSpace(TextureFormat format, TextureColorSpace colorSpace)
+	{
+		//Two channel BC5 holds vectors, not colors
+		return format != TextureFormat::BC5 || colorSpace == TextureColorSpace::Linear;
+	}
+
+	Texture* Texture::Load(const std::string& path, TexelLayout layout, TextureFormat format, TextureColorSpace colorSpace)
+	{
+		if (!IsValidColorSpace(format, colorSpace))
+			return nullptr;
+
+		SDL_Surface* pSurface{ IMG_Load(path.c_str()) };
+		if (!pSurface)
+			return nullptr;
+
+		Texture* pTexture{ new Texture(layout, format, colorSpace) };
+		const bool isLoaded{ LoadBaseLevel(pSurface, pTexture->m_MipLevels.emplace_back()) };
+		SDL_FreeSurface(pSurface);
+
+		if (!isLoaded)
+		{
+			delete pTexture;
+			return nullptr;
+		}
+
+		pTexture->m_Path = path;
+		pTexture->Finalize();
+		return pTexture;
+	}
+
+	bool Texture::LoadBaseLevel(SDL_Surface* pSurface, MipLevel& baseLevel)
+	{
+		//Convert once to a known channel order instead of going through the SDL_PixelFormat on every sample
+		SDL_Surface* pConverted{ SDL_ConvertSurfaceFormat(pSurface, SDL_PIXELFORMAT_ABGR8888, 0) };
+		if (!pConverted)
+			return false;
+
+		baseLevel.width = pConverted->w;
+		baseLevel.height = pConverted->h;
+		baseLevel.texels.resize(size_t(baseLevel.width) * baseLevel.height);
+
+		SDL_LockSurface(pConverted);
+		for (int y{}; y < baseLevel.height; ++y)
+		{
+			const uint8_t* pRow{ static_cast<const uint8_t*>(pConverted->pixels) + size_t(y) * pConverted->pitch };
+			std::memcpy(&baseLevel.texels[size_t(y) * baseLevel.width], pRow, size_t(baseLevel.width) * sizeof(uint32_t));
+		}
+		SDL_UnlockSurface(pConverted);
+
+		SDL_FreeSurface(pConverted);
+		return true;
+	}
+
+	void Texture::Finalize()
+	{
+		GenerateMipLevels();
+
+		for (int level{}; level < int(m_MipLevels.size()); ++level)
+			EncodeMipLevel(m_MipLevels[level], level);
+
+		SelectSamplers();
+
+		m_LastUsedFrames = std::vector<std::atomic<uint32_t>>(m_MipLevels.size());
+		m_RequestedLevels = std::vector<std::atomic<bool>>(m_MipLevels.size());
+	}
+
+	size_t Texture::GetMemorySize() const
+	{
+		size_t size{};
+		for (const MipLevel& level : m_MipLevels)
+			size += level.texels.size() * sizeof(uint32_t) + level.blocks.size();
+		return size;
+	}
+
+	void Texture::GenerateMipLevels()
+	{
+		while (m_MipLevels.back().width > 1 || m_MipLevels.back().height > 1)
+			m_MipLevels.emplace_back(Downsample(m_MipLevels.back()));
 	}
 
-	Texture::~Texture()
+	Texture::MipLevel Texture::Downsample(const MipLevel& source) const
 	{
-		if (m_pSurface)
+		//Box filter, odd edges repeat their last texel
+		//sRGB texels are averaged in linear space, so smaller mips don't darken
+		const auto average{ m_IsSRGB ? &AverageSRGB : &Average };
+
+		MipLevel level{};
+		level.width = std::max(source.width / 2, 1);
+		level.height = std::max(source.height / 2, 1);
+		level.texels.resize(size_t(level.width) * level.height);
+
+		for (int y{}; y < level.height; ++y)
+		{
+			const int y0{ std::min(y * 2, source.height - 1) };
+			const int y1{ std::min(y * 2 + 1, source.height - 1) };
+
+			for (int x{}; x < level.width; ++x)
+			{
+				const int x0{ std::min(x * 2, source.width - 1) };
+				const int x1{ std::min(x * 2 + 1, source.width - 1) };
+
+				level.texels[x + (size_t(y) * level.width)] = average(
+					source.texels[x0 + (size_t(y0) * source.width)], source.texels[x1 + (size_t(y0) * source.width)],
+					source.texels[x0 + (size_t(y1) * source.width)], source.texels[x1 + (size_t(y1) * source.width)]);
+			}
+		}
+
+		return level;
+	}
+
+	void Texture::EncodeMipLevel(MipLevel& level, int levelIndex) const
+	{
+		//Mips are generated linearly, then every level is reordered or compressed once
+		if (m_Format == TextureFormat::RGBA8)
+			ApplyLayout(level);
+		else
+			CompressMipLevel(level, levelIndex);
+	}
+
+	void Texture::ApplyLayout(MipLevel& level) const
+	{
+		const int tileSize{ m_Layout == TexelLayout::Tiled4x4 ? 4 : 8 };
+		level.tilesPerRow = (level.width + tileSize - 1) / tileSize;
+		level.mortonBits = std::min(CeilLog2(level.width), CeilLog2(level.height));
+
+		size_t storageSize{};
+		size_t(*texelIndex)(const MipLevel&, int, int){ nullptr };
+		switch (m_Layout)
+		{
+		case TexelLayout::Tiled4x4:
+			storageSize = size_t(level.tilesPerRow) * ((level.height + tileSize - 1) / tileSize) * tileSize * tileSize;
+			texelIndex = &TexelIndex<TexelLayout::Tiled4x4>;
+			break;
+		case TexelLayout::Tiled8x8:
+			storageSize = size_t(level.tilesPerRow) * ((level.height + tileSize - 1) / tileSize) * tileSize * tileSize;
+			texelIndex = &TexelIndex<TexelLayout::Tiled8x8>;
+			break;
+		case TexelLayout::Morton:
+			storageSize = size_t(1) << (CeilLog2(level.width) + CeilLog2(level.height));
+			texelIndex = &TexelIndex<TexelLayout::Morton>;
+			break;
+		default:
+			return;
+		}
+
+		std::vector<uint32_t> texels(storageSize);
+		for (int y{}; y < level.height; ++y)
+		{
+			for (int x{}; x < level.width; ++x)
+				texels[texelIndex(level, x, y)] = level.texels[x + (size_t(y) * level.width)];
+		}
+		level.texels = std::move(texels);
+	}
+
+	void Texture::CompressMipLevel(MipLevel& level, int levelIndex) const
+	{
+		const size_t blockSize{ BlockCompression::GetBlockSize(m_Format) };
+		level.blocksPerRow = (level.width + 3) / 4;
+		level.blockCacheKey = (uint64_t(m_Id) << 40) | (uint64_t(levelIndex) << 32);
+
+		const int blockRows{ (level.height + 3) / 4 };
+		level.blocks.resize(size_t(level.blocksPerRow) * blockRows * blockSize);
+
+		//Blocks past the edge of small or odd sized levels repeat the edge texels
+		uint32_t blockTexels[16]{};
+		for (int blockY{}; blockY < blockRows; ++blockY)
+		{
+			for (int blockX{}; blockX < level.blocksPerRow; ++blockX)
+			{
+				for (int i{}; i < 16; ++i)
+				{
+					const int x{ std::min(blockX * 4 + (i & 3), level.width - 1) };
+					const int y{ std::min(blockY * 4 + (i >> 2), level.height - 1) };
+					blockTexels[i] = level.texels[x + (size_t(y) * level.width)];
+				}
+
+				BlockCompression::EncodeBlock(m_Format, blockTexels, &level.blocks[(size_t(blockY) * level.blocksPerRow + blockX) * blockSize]);
+			}
+		}
+
+		std::vector<uint32_t>{}.swap(level.texels);
+	}
+
+	uint32_t Texture::FetchCompressedTexel(const MipLevel& level, int x, int y) const
+	{
+		const uint32_t blockIndex{ uint32_t((y >> 2) * level.blocksPerRow + (x >> 2)) };
+		const uint64_t key{ level.blockCacheKey | blockIndex };
+
+		DecodedBlock& decoded{ t_DecodedBlocks[(blockIndex ^ uint32_t(key >> 32)) % t_DecodedBlocks.size()] };
+		if (decoded.key != key)
 		{
-			SDL_FreeSurface(m_pSurface);
-			m_pSurface = nullptr;
+			const size_t blockSize{ BlockCompression::GetBlockSize(m_Format) };
+			BlockCompression::DecodeBlock(m_Format, &level.blocks[blockIndex * blockSize], decoded.texels);
+			decoded.key = key;
 		}
+
+		return decoded.texels[(y & 3) * 4 + (x & 3)];
+	}
+
+	template<TexelLayout layout, bool isCompressed>
+	uint32_t Texture::FetchTexel(const MipLevel& level, int x, int y) const
+	{
+		if constexpr (isCompressed)
+			return FetchCompressedTexel(level, x, y);
+		else
+			return level.texels[TexelIndex<layout>(level, x, y)];
 	}
 
-	Texture* Texture::LoadFromFile(const std::string& path)
+	template<TexelLayout layout>
+	size_t Texture::TexelIndex(const MipLevel& level, int x, int y)
 	{
-		//TODO
-		//Load SDL_Surface using IMG_LOAD
-		//Create & Return a new Texture Object (using SDL_Surface)
-		
-		//SDL_Surface* surface{ IMG_Load(path.c_str()) };
-		
-		return new Texture(IMG_Load(path.c_str()));
+		if constexpr (layout == TexelLayout::Tiled4x4)
+		{
+			return TiledIndex<2>(level.tilesPerRow, x, y);
+		}
+		else if constexpr (layout == TexelLayout::Tiled8x8)
+		{
+			return TiledIndex<3>(level.tilesPerRow, x, y);
+		}
+		else if constexpr (layout == TexelLayout::Morton)
+		{
+			//Interleave the square part, the remaining high bits of the longest axis select the square
+			const uint32_t mask{ (1u << level.mortonBits) - 1 };
+			const size_t square{ size_t((uint32_t(x) >> level.mortonBits) | (uint32_t(y) >> level.mortonBits)) };
+			return (square << (level.mortonBits * 2)) | (SpreadBits(uint32_t(y) & mask) << 1) | SpreadBits(uint32_t(x) & mask);
+		}
+		else
+		{
+			return x + (size_t(y) * level.width);
+		}
 	}
 
 	ColorRGB Texture::Sample(const Vector2& uv) const
 	{
-		//TODO
-		//Sample the correct texel for the given uv
-		
-		Uint8 r{}, g{}, b{};
+		return (this->*m_pSample)(uv, 0.f);
+	}
+
+	ColorRGB Texture::Sample(const Vector2& uv, float lod) const
+	{
+		return (this->*m_pSample)(uv, lod);
+	}
+
+	void Texture::SampleSpan(const Vector2* pUVs, float lod, ColorRGB* pColors, size_t count) const
+	{
+		(this->*m_pSampleSpan)(pUVs, lod, pColors, count);
+	}
+
+	void Texture::SetAddressMode(AddressMode addressMode)
+	{
+		m_AddressMode = addressMode;
+		SelectSamplers();
+	}
+
+	float Texture::CalculateLOD(const Vector2& dUVdx, const Vector2& dUVdy) const
+	{
+		//Footprint of one pixel in base level texels, the longest axis picks the level
+		const Vector2 size{ float(GetWidth()), float(GetHeight()) };
+		const float lengthX{ Vector2{ dUVdx.x * size.x, dUVdx.y * size.y }.SqrMagnitude() };
+		const float lengthY{ Vector2{ dUVdy.x * size.x, dUVdy.y * size.y }.SqrMagnitude() };
+
+		//log2(sqrt(x)) == 0.5 * log2(x)
+		return std::max(0.5f * std::log2(std::max(lengthX, lengthY)), 0.f);
+	}
+
+	int Texture::NearestMipLevel(float lod) const
+	{
+		return Clamp(int(lod + .5f), 0, int(m_MipLevels.size()) - 1);
+	}
+
+	int Texture::ResidentMipLevel(int level) const
+	{
+		//Only store when the stamp changes, so concurrent samplers don't keep the cache line dirty
+		const uint32_t frame{ m_pCurrentFrame->load(std::memory_order_relaxed) };
+		if (m_LastUsedFrames[level].load(std::memory_order_relaxed) != frame)
+			m_LastUsedFrames[level].store(frame, std::memory_order_relaxed);
+
+		while (!IsMipLevelResident(level))
+		{
+			if (!m_RequestedLevels[level].load(std::memory_order_relaxed))
+				m_RequestedLevels[level].store(true, std::memory_order_relaxed);
+			++level;
+		}
+
+		if (m_LastUsedFrames[level].load(std::memory_order_relaxed) != frame)
+			m_LastUsedFrames[level].store(frame, std::memory_order_relaxed);
+		return level;
+	}
+
+	bool Texture::IsMipLevelResident(int level) const
+	{
+		return !m_MipLevels[level].texels.empty() || !m_MipLevels[level].blocks.empty();
+	}
+
+	size_t Texture::GetMipLevelSize(int level) const
+	{
+		const MipLevel& mipLevel{ m_MipLevels[level] };
+		if (!IsMipLevelResident(level))
+			return mipLevel.evictedSize;
+		return mipLevel.texels.size() * sizeof(uint32_t) + mipLevel.blocks.size();
+	}
+
+	uint32_t Texture::GetMipLevelLastUsedFrame(int level) const
+	{
+		return m_LastUsedFrames[level].load(std::memory_order_relaxed);
+	}
+
+	bool Texture::IsMipLevelRequested(int level) const
+	{
+		return m_RequestedLevels[level].load(std::memory_order_relaxed);
+	}
+
+	bool Texture::HasRequestedMipLevels() const
+	{
+		for (const std::atomic<bool>& isRequested : m_RequestedLevels)
+		{
+			if (isRequested.load(std::memory_order_relaxed))
+				return true;
+		}
+		return false;
+	}
+
+	void Texture::EvictMipLevel(int level)
+	{
+		if (!IsEvictable() || level >= int(m_MipLevels.size()) - 1 || !IsMipLevelResident(level))
+			return;
+
+		MipLevel& mipLevel{ m_MipLevels[level] };
+		mipLevel.evictedSize = GetMipLevelSize(level);
+		//Swap with empty vectors, clear() would keep the capacity
+		std::vector<uint32_t>{}.swap(mipLevel.texels);
+		std::vector<uint8_t>{}.swap(mipLevel.blocks);
+	}
+
+	bool Texture::BeginReload()
+	{
+		if (!IsEvictable() || m_IsReloading)
+			return false;
+
+		uint32_t levelMask{};
+		for (int level{}; level < int(m_MipLevels.size()); ++level)
+		{
+			if (m_RequestedLevels[level].exchange(false, std::memory_order_relaxed) && !IsMipLevelResident(level))
+				levelMask |= 1u << level;
+		}
+		if (levelMask == 0)
+			return false;
+
+		m_ReloadMask = levelMask;
+		m_IsReloading = true;
+		m_IsReloadDecoded.store(false, std::memory_order_relaxed);
+		return true;
+	}
+
+	void Texture::DecodeReload()
+	{
+		//Only reads what stays the same after the first load, so samples and evictions can go on meanwhile
+		SDL_Surface* pSurface{ IMG_Load(m_Path.c_str()) };
+		MipLevel level{};
+		const bool isLoaded{ pSurface && LoadBaseLevel(pSurface, level) };
+		if (pSurface)
+			SDL_FreeSurface(pSurface);
+
+		//Every level is filtered from the one before it, only the requested ones are encoded and kept
+		if (isLoaded && level.width == GetWidth() && level.height == GetHeight())
+		{
+			for (int levelIndex{}; levelIndex < int(m_MipLevels.size()) && (m_ReloadMask >> levelIndex) != 0; ++levelIndex)
+			{
+				if (levelIndex > 0)
+					level = Downsample(level);
+
+				if (m_ReloadMask & (1u << levelIndex))
+					EncodeMipLevel(m_ReloadedLevels.emplace_back(level), levelIndex);
+			}
+		}
+
+		m_IsReloadDecoded.store(true, std::memory_order_release);
+	}
+
+	bool Texture::FinishReload()
+	{
+		if (!m_IsReloading || !m_IsReloadDecoded.load(std::memory_order_acquire))
+			return false;
+		m_IsReloading = false;
+
+		//A source that can no longer be decoded keeps the levels that are resident and is never evicted again
+		if (m_ReloadedLevels.empty())
+		{
+			m_Path.clear();
+			return false;
+		}
+
+		//The levels were requested by the last samples, so they count as used now and are not evicted right away
+		const uint32_t frame{ m_pCurrentFrame->load(std::memory_order_relaxed) };
+		std::vector<MipLevel>::iterator reloaded{ m_ReloadedLevels.begin() };
+		for (int level{}; level < int(m_MipLevels.size()); ++level)
+		{
+			if (!(m_ReloadMask & (1u << level)))
+				continue;
+
+			m_MipLevels[level].texels = std::move(reloaded->texels);
+			m_MipLevels[level].blocks = std::move(reloaded->blocks);
+			m_LastUsedFrames[level].store(frame, std::memory_order_relaxed);
+			++reloaded;
+		}
+
+		m_ReloadedLevels.clear();
+		return true;
+	}
+
+	void Texture::SelectSamplers()
+	{
+		//Resolve storage, address mode and power of two once, so no sample has to branch on them
+		//Compressed textures keep their 4x4 block order, only RGBA8 texels are reordered
+		if (m_Format != TextureFormat::RGBA8)
+		{
+			SelectSamplers<TexelLayout::Linear, true>();
+			return;
+		}
+
+		switch (m_Layout)
+		{
+		case TexelLayout::Tiled4x4:
+			SelectSamplers<TexelLayout::Tiled4x4, false>();
+			break;
+		case TexelLayout::Tiled8x8:
+			SelectSamplers<TexelLayout::Tiled8x8, false>();
+			break;
+		case TexelLayout::Morton:
+			SelectSamplers<TexelLayout::Morton, false>();
+			break;
+		default:
+			SelectSamplers<TexelLayout::Linear, false>();
+			break;
+		}
+	}
+
+	template<TexelLayout layout, bool isCompressed>
+	void Texture::SelectSamplers()
+	{
+		const bool isPowerOfTwo{ IsPowerOfTwo(GetWidth()) && IsPowerOfTwo(GetHeight()) };
+
+		switch (m_AddressMode)
+		{
+		case AddressMode::Clamp:
+			SetSamplers<AddressMode::Clamp, false, layout, isCompressed>();
+			break;
+		case AddressMode::Mirror:
+			isPowerOfTwo ? SetSamplers<AddressMode::Mirror, true, layout, isCompressed>() : SetSamplers<AddressMode::Mirror, false, layout, isCompressed>();
+			break;
+		default:
+			isPowerOfTwo ? SetSamplers<AddressMode::Wrap, true, layout, isCompressed>() : SetSamplers<AddressMode::Wrap, false, layout, isCompressed>();
+			break;
+		}
+	}
+
+	template<AddressMode mode, bool isPowerOfTwo, TexelLayout layout, bool isCompressed>
+	void Texture::SetSamplers()
+	{
+		m_pSample = &Texture::SampleFiltered<mode, isPowerOfTwo, layout, isCompressed>;
+		m_pSampleSpan = &Texture::SampleSpanFiltered<mode, isPowerOfTwo, layout, isCompressed>;
+	}
+
+	template<AddressMode mode, bool isPowerOfTwo, TexelLayout layout, bool isCompressed>
+	ColorRGB Texture::SampleFiltered(const Vector2& uv, float lod) const
+	{
+		switch (m_Filter)
+		{
+		case TextureFilter::Point:
+			return SamplePoint<mode, isPowerOfTwo, layout, isCompressed>(m_MipLevels[ResidentMipLevel(NearestMipLevel(lod))], uv);
+		case TextureFilter::Bilinear:
+			return SampleBilinear<mode, isPowerOfTwo, layout, isCompressed>(m_MipLevels[ResidentMipLevel(NearestMipLevel(lod))], uv);
+		default:
+			break;
+		}
+
+		const float maxLod{ float(m_MipLevels.size() - 1) };
+		lod = Clamp(lod, 0.f, maxLod);
+
+		//A level that fell back to a coarser one has nothing coarser of its own to blend with
+		const int level0{ ResidentMipLevel(int(lod)) };
+		const float fraction{ level0 == int(lod) ? lod - float(level0) : 0.f };
+
+		const ColorRGB color0{ SampleBilinear<mode, isPowerOfTwo, layout, isCompressed>(m_MipLevels[level0], uv) };
+		if (level0 + 1 >= int(m_MipLevels.size()) || fraction <= 0.f)
+			return color0;
+
+		const int level1{ ResidentMipLevel(level0 + 1) };
+		return ColorRGB::Lerp(color0, SampleBilinear<mode, isPowerOfTwo, layout, isCompressed>(m_MipLevels[level1], uv), fraction);
+	}
+
+	template<AddressMode mode, bool isPowerOfTwo, TexelLayout layout, bool isCompressed>
+	void Texture::SampleSpanFiltered(const Vector2* pUVs, float lod, ColorRGB* pColors, size_t count) const
+	{
+		if (m_Filter == TextureFilter::Point)
+		{
+			const MipLevel& level{ m_MipLevels[ResidentMipLevel(NearestMipLevel(lod))] };
+			for (size_t i{}; i < count; ++i)
+				pColors[i] = SamplePoint<mode, isPowerOfTwo, layout, isCompressed>(level, pUVs[i]);
+			return;
+		}
+
+		if (m_Filter == TextureFilter::Bilinear)
+		{
+			SampleBilinearSpan<mode, isPowerOfTwo, layout, isCompressed>(m_MipLevels[ResidentMipLevel(NearestMipLevel(lod))], pUVs, pColors, count);
+			return;
+		}
+
+		const float maxLod{ float(m_MipLevels.size() - 1) };
+		lod = Clamp(lod, 0.f, maxLod);
+
+		const int level0{ ResidentMipLevel(int(lod)) };
+		const float fraction{ level0 == int(lod) ? lod - float(level0) : 0.f };
+
+		SampleBilinearSpan<mode, isPowerOfTwo, layout, isCompressed>(m_MipLevels[level0], pUVs, pColors, count);
+		if (level0 + 1 >= int(m_MipLevels.size()) || fraction <= 0.f)
+			return;
+
+		const int level1{ ResidentMipLevel(level0 + 1) };
+		ColorRGB nextLevelColors[8]{};
+		for (size_t first{}; first < count; first += std::size(nextLevelColors))
+		{
+			const size_t spanCount{ std::min(std::size(nextLevelColors), count - first) };
+			SampleBilinearSpan<mode, isPowerOfTwo, layout, isCompressed>(m_MipLevels[level1], pUVs + first, nextLevelColors, spanCount);
+
+			for (size_t i{}; i < spanCount; ++i)
+				pColors[first + i] = ColorRGB::Lerp(pColors[first + i], nextLevelColors[i], fraction);
+		}
+	}
+
+	template<AddressMode mode, bool isPowerOfTwo, TexelLayout layout, bool isCompressed>
+	ColorRGB Texture::SamplePoint(const MipLevel& level, const Vector2& uv) const
+	{
+		const int x{ AddressTexel<mode, isPowerOfTwo>(FloorToInt(uv.x * level.width), level.width) };
+		const int y{ AddressTexel<mode, isPowerOfTwo>(FloorToInt(uv.y * level.height), level.height) };
+
+		return Unpack(FetchTexel<layout, isCompressed>(level, x, y), m_pByteToFloat);
+	}
+
+	template<AddressMode mode, bool isPowerOfTwo, TexelLayout layout, bool isCompressed>
+	ColorRGB Texture::SampleBilinear(const MipLevel& level, const Vector2& uv) const
+	{
+		//Texel centers sit at half integer coordinates
+		const float x{ uv.x * level.width - .5f };
+		const float y{ uv.y * level.height - .5f };
 
-		size_t x{ static_cast<size_t>(uv.x * m_pSurface->w) };
-		size_t y{ static_cast<size_t>(uv.y * m_pSurface->h) };
+		const int floorX{ FloorToInt(x) };
+		const int floorY{ FloorToInt(y) };
 
-		//m_pBackBufferPixels[px + (py * m_Width)]
-		Uint32 pixel{ m_pSurfacePixels[x + (y * m_pSurface->w)] };
-		
-		SDL_GetRGB(pixel, m_pSurface->format, &r, &g, &b);
+		const float fractionX{ x - float(floorX) };
+		const float fractionY{ y - float(floorY) };
 
-		return ColorRGB{ float(r) / 255.f, float(g) / 255.f, float(b) / 255.f };
+		const int x0{ AddressTexel<mode, isPowerOfTwo>(floorX, level.width) };
+		const int y0{ AddressTexel<mode, isPowerOfTwo>(floorY, level.height) };
+		const int x1{ AddressTexel<mode, isPowerOfTwo>(floorX + 1, level.width) };
+		const int y1{ AddressTexel<mode, isPowerOfTwo>(floorY + 1, level.height) };
+
+		const ColorRGB top{ ColorRGB::Lerp(Unpack(FetchTexel<layout, isCompressed>(level, x0, y0), m_pByteToFloat),
+			Unpack(FetchTexel<layout, isCompressed>(level, x1, y0), m_pByteToFloat), fractionX) };
+		const ColorRGB bottom{ ColorRGB::Lerp(Unpack(FetchTexel<layout, isCompressed>(level, x0, y1), m_pByteToFloat),
+			Unpack(FetchTexel<layout, isCompressed>(level, x1, y1), m_pByteToFloat), fractionX) };
+
+		return ColorRGB::Lerp(top, bottom, fractionY);
+	}
+
+	template<AddressMode mode, bool isPowerOfTwo, TexelLayout layout, bool isCompressed>
+	void Texture::SampleBilinearSpan(const MipLevel& level, const Vector2* pUVs, ColorRGB* pColors, size_t count) const
+	{
+		const __m128 width{ _mm_set1_ps(float(level.width)) };
+		const __m128 height{ _mm_set1_ps(float(level.height)) };
+		const __m128 half{ _mm_set1_ps(.5f) };
+		//The sRGB table decodes straight to [0, 1]
+		const __m128 toUnit{ _mm_set1_ps(m_IsSRGB ? 1.f : 1.f / 255.f) };
+
+		for (size_t first{}; first < count; first += 4)
+		{
+			const size_t laneCount{ std::min<size_t>(4, count - first) };
+
+			//Unused lanes sample uv (0, 0), addressing keeps them in bounds
+			alignas(16) float us[4]{};
+			alignas(16) float vs[4]{};
+			for (size_t lane{}; lane < laneCount; ++lane)
+			{
+				us[lane] = pUVs[first + lane].x;
+				vs[lane] = pUVs[first + lane].y;
+			}
+
+			//Texel centers sit at half integer coordinates
+			const __m128 x{ _mm_sub_ps(_mm_mul_ps(_mm_load_ps(us), width), half) };
+			const __m128 y{ _mm_sub_ps(_mm_mul_ps(_mm_load_ps(vs), height), half) };
+
+			const __m128i floorX{ FloorToInt(x) };
+			const __m128i floorY{ FloorToInt(y) };
+			const __m128 fractionX{ _mm_sub_ps(x, _mm_cvtepi32_ps(floorX)) };
+			const __m128 fractionY{ _mm_sub_ps(y, _mm_cvtepi32_ps(floorY)) };
+
+			alignas(16) int32_t floorXs[4], floorYs[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(floorXs), floorX);
+			_mm_store_si128(reinterpret_cast<__m128i*>(floorYs), floorY);
+
+			//Gather the four corners of every lane
+			alignas(16) uint32_t topLeft[4], topRight[4], bottomLeft[4], bottomRight[4];
+			for (size_t lane{}; lane < 4; ++lane)
+			{
+				const int x0{ AddressTexel<mode, isPowerOfTwo>(floorXs[lane], level.width) };
+				const int y0{ AddressTexel<mode, isPowerOfTwo>(floorYs[lane], level.height) };
+				const int x1{ AddressTexel<mode, isPowerOfTwo>(floorXs[lane] + 1, level.width) };
+				const int y1{ AddressTexel<mode, isPowerOfTwo>(floorYs[lane] + 1, level.height) };
+
+				topLeft[lane] = FetchTexel<layout, isCompressed>(level, x0, y0);
+				topRight[lane] = FetchTexel<layout, isCompressed>(level, x1, y0);
+				bottomLeft[lane] = FetchTexel<layout, isCompressed>(level, x0, y1);
+				bottomRight[lane] = FetchTexel<layout, isCompressed>(level, x1, y1);
+			}
+
+			const __m128i texels00{ _mm_load_si128(reinterpret_cast<const __m128i*>(topLeft)) };
+			const __m128i texels10{ _mm_load_si128(reinterpret_cast<const __m128i*>(topRight)) };
+			const __m128i texels01{ _mm_load_si128(reinterpret_cast<const __m128i*>(bottomLeft)) };
+			const __m128i texels11{ _mm_load_si128(reinterpret_cast<const __m128i*>(bottomRight)) };
+
+			const auto blend = [&](__m128 c00, __m128 c10, __m128 c01, __m128 c11)
+			{
+				const __m128 top{ _mm_add_ps(c00, _mm_mul_ps(_mm_sub_ps(c10, c00), fractionX)) };
+				const __m128 bottom{ _mm_add_ps(c01, _mm_mul_ps(_mm_sub_ps(c11, c01), fractionX)) };
+				return _mm_mul_ps(_mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), fractionY)), toUnit);
+			};
+
+			alignas(16) float r[4], g[4], b[4];
+			if (m_IsSRGB)
+			{
+				_mm_store_ps(r, blend(DecodeChannel<0>(topLeft), DecodeChannel<0>(topRight), DecodeChannel<0>(bottomLeft), DecodeChannel<0>(bottomRight)));
+				_mm_store_ps(g, blend(DecodeChannel<8>(topLeft), DecodeChannel<8>(topRight), DecodeChannel<8>(bottomLeft), DecodeChannel<8>(bottomRight)));
+				_mm_store_ps(b, blend(DecodeChannel<16>(topLeft), DecodeChannel<16>(topRight), DecodeChannel<16>(bottomLeft), DecodeChannel<16>(bottomRight)));
+			}
+			else
+			{
+				_mm_store_ps(r, blend(UnpackChannel<0>(texels00), UnpackChannel<0>(texels10), UnpackChannel<0>(texels01), UnpackChannel<0>(texels11)));
+				_mm_store_ps(g, blend(UnpackChannel<8>(texels00), UnpackChannel<8>(texels10), UnpackChannel<8>(texels01), UnpackChannel<8>(texels11)));
+				_mm_store_ps(b, blend(UnpackChannel<16>(texels00), UnpackChannel<16>(texels10), UnpackChannel<16>(texels01), UnpackChannel<16>(texels11)));
+			}
+
+			for (size_t lane{}; lane < laneCount; ++lane)
+				pColors[first + lane] = ColorRGB{ r[lane], g[lane], b[lane] };
+		}
 	}
-}
\ No newline at end of file
+}
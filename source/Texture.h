@@ -1,24 +1,192 @@
 #pragma once
 #include <SDL_surface.h>
+#include <atomic>
 #include <string>
+#include <vector>
+#include "BlockCompression.h"
 #include "ColorRGB.h"
 
 namespace dae
 {
 	struct Vector2;
 
+	//Order in which the texels of every mip level are stored
+	enum class TexelLayout
+	{
+		Linear,
+		Tiled4x4,
+		Tiled8x8,
+		Morton
+	};
+
+	enum class TextureFilter
+	{
+		Point,		//Nearest texel of the nearest mip level
+		Bilinear,	//Four texels of the nearest mip level
+		Trilinear	//Bilinear samples of the two nearest mip levels, blended
+	};
+
+	//Encoding of the stored channels, data such as normal, roughness and mask maps is linear
+	enum class TextureColorSpace
+	{
+		SRGB,
+		Linear
+	};
+
+	//How uvs outside [0, 1) are mapped onto the texture
+	enum class AddressMode
+	{
+		Wrap,
+		Clamp,
+		Mirror
+	};
+
 	class Texture
 	{
 	public:
-		~Texture();
+		~Texture() = default;
+
+		static Texture* LoadFromFile(const std::string& path, TexelLayout layout = TexelLayout::Linear, TextureColorSpace colorSpace = TextureColorSpace::SRGB);
+		//Block compresses every mip level on load, compressed textures keep their 4x4 block order
+		//Without a color space the format picks its default one
+		static Texture* LoadFromFile(const std::string& path, TextureFormat format);
+		static Texture* LoadFromFile(const std::string& path, TextureFormat format, TextureColorSpace colorSpace);
+		//Takes ownership of a copy of block compressed base level data, smaller mips are generated from it
+		static Texture* CreateFromBlocks(TextureFormat format, int width, int height, const std::vector<uint8_t>& blocks);
+		static Texture* CreateFromBlocks(TextureFormat format, TextureColorSpace colorSpace, int width, int height, const std::vector<uint8_t>& blocks);
+		//1x1 texture of a single color
+		static Texture* CreateSolid(const ColorRGB& color);
 
-		static Texture* LoadFromFile(const std::string& path);
+		//BC5 holds two channel vectors and is always linear, every other format defaults to sRGB color
+		static TextureColorSpace GetDefaultColorSpace(TextureFormat format);
+		static bool IsValidColorSpace(TextureFormat format, TextureColorSpace colorSpace);
+
+		//Sample of the base level
 		ColorRGB Sample(const Vector2& uv) const;
+		//Sample at a level of detail, lod 0 is the base level
+		ColorRGB Sample(const Vector2& uv, float lod) const;
+		//Samples count uvs at one level of detail, bilinear filtering runs four uvs at a time with SSE
+		void SampleSpan(const Vector2* pUVs, float lod, ColorRGB* pColors, size_t count) const;
+
+		//Level of detail from the screen space derivatives of uv
+		float CalculateLOD(const Vector2& dUVdx, const Vector2& dUVdy) const;
+
+		int GetWidth() const { return m_MipLevels.front().width; }
+		int GetHeight() const { return m_MipLevels.front().height; }
+		int GetMipLevelCount() const { return int(m_MipLevels.size()); }
+		TexelLayout GetLayout() const { return m_Layout; }
+		TextureFormat GetFormat() const { return m_Format; }
+		TextureColorSpace GetColorSpace() const { return m_IsSRGB ? TextureColorSpace::SRGB : TextureColorSpace::Linear; }
+		//sRGB texels are decoded to linear values when sampled and averaged in linear space for the mips
+		bool IsSRGB() const { return m_IsSRGB; }
+		//Bytes held by all mip levels
+		size_t GetMemorySize() const;
+		TextureFilter GetFilter() const { return m_Filter; }
+		void SetFilter(TextureFilter filter) { m_Filter = filter; }
+		AddressMode GetAddressMode() const { return m_AddressMode; }
+		void SetAddressMode(AddressMode addressMode);
+
+		//Residency, only change it between frames while nothing samples the texture
+		//Samples stamp the levels they touch with the frame of the TextureManager the texture is tracked by
+		//Textures without a source file can not be reloaded, so they are never evicted
+		bool IsEvictable() const { return !m_Path.empty(); }
+		bool IsMipLevelResident(int level) const;
+		//Bytes the level holds, or held before it was evicted
+		size_t GetMipLevelSize(int level) const;
+		uint32_t GetMipLevelLastUsedFrame(int level) const;
+		bool IsMipLevelRequested(int level) const;
+		bool HasRequestedMipLevels() const;
+		//The coarsest level always stays resident so every sample has a fallback
+		void EvictMipLevel(int level);
+		bool IsReloading() const { return m_IsReloading; }
 
 	private:
-		Texture(SDL_Surface* pSurface);
+		friend class TextureLoader;
+		friend class TextureManager;
+
+		struct MipLevel
+		{
+			int width{};
+			int height{};
+			int tilesPerRow{}; //Tiled layouts
+			int mortonBits{}; //Morton layout, bits of the smallest padded dimension
+			int blocksPerRow{}; //Compressed formats
+			uint64_t blockCacheKey{}; //Compressed formats, texture id and level index for the decoded block cache
+			size_t evictedSize{}; //Bytes the level held before it was evicted
+			//Packed RGBA8 texels, red in the lowest byte (SDL_PIXELFORMAT_ABGR8888)
+			std::vector<uint32_t> texels{};
+			//Block compressed data, row by row of 4x4 blocks, replaces texels for the BC formats
+			std::vector<uint8_t> blocks{};
+		};
+
+		Texture(TexelLayout layout, TextureFormat format, TextureColorSpace colorSpace);
+
+		static Texture* Load(const std::string& path, TexelLayout layout, TextureFormat format, TextureColorSpace colorSpace);
+		static bool LoadBaseLevel(SDL_Surface* pSurface, MipLevel& baseLevel);
+		void Finalize();
+		void GenerateMipLevels();
+		MipLevel Downsample(const MipLevel& source) const;
+		void EncodeMipLevel(MipLevel& level, int levelIndex) const;
+		void ApplyLayout(MipLevel& level) const;
+		void CompressMipLevel(MipLevel& level, int levelIndex) const;
+
+		//Reloads restore evicted levels without blocking a frame, the loader decodes and the manager installs
+		//Takes the requested levels that are not resident, false when there are none or a reload is in flight
+		bool BeginReload();
+		//Runs as a job, filters the whole chain from the source file but only encodes and keeps the taken levels
+		void DecodeReload();
+		//Between frames, installs the decoded levels once the job has finished
+		bool FinishReload();
+
+		template<TexelLayout layout>
+		static size_t TexelIndex(const MipLevel& level, int x, int y);
+		uint32_t FetchCompressedTexel(const MipLevel& level, int x, int y) const;
+		int NearestMipLevel(float lod) const;
+		//Marks the level used, evicted levels fall back to the next coarser resident one and are requested
+		int ResidentMipLevel(int level) const;
+		void SelectSamplers();
+		template<TexelLayout layout, bool isCompressed>
+		void SelectSamplers();
+		template<AddressMode mode, bool isPowerOfTwo, TexelLayout layout, bool isCompressed>
+		void SetSamplers();
+
+		//Instantiated per address mode, layout and storage, power of two sizes wrap with a mask
+		template<TexelLayout layout, bool isCompressed>
+		uint32_t FetchTexel(const MipLevel& level, int x, int y) const;
+		template<AddressMode mode, bool isPowerOfTwo, TexelLayout layout, bool isCompressed>
+		ColorRGB SampleFiltered(const Vector2& uv, float lod) const;
+		template<AddressMode mode, bool isPowerOfTwo, TexelLayout layout, bool isCompressed>
+		void SampleSpanFiltered(const Vector2* pUVs, float lod, ColorRGB* pColors, size_t count) const;
+		template<AddressMode mode, bool isPowerOfTwo, TexelLayout layout, bool isCompressed>
+		ColorRGB SamplePoint(const MipLevel& level, const Vector2& uv) const;
+		template<AddressMode mode, bool isPowerOfTwo, TexelLayout layout, bool isCompressed>
+		ColorRGB SampleBilinear(const MipLevel& level, const Vector2& uv) const;
+		template<AddressMode mode, bool isPowerOfTwo, TexelLayout layout, bool isCompressed>
+		void SampleBilinearSpan(const MipLevel& level, const Vector2* pUVs, ColorRGB* pColors, size_t count) const;
+
+		using SampleFunction = ColorRGB(Texture::*)(const Vector2&, float) const;
+		using SampleSpanFunction = void(Texture::*)(const Vector2*, float, ColorRGB*, size_t) const;
+
+		std::vector<MipLevel> m_MipLevels{};
+		mutable std::vector<std::atomic<uint32_t>> m_LastUsedFrames{};
+		mutable std::vector<std::atomic<bool>> m_RequestedLevels{};
+		//Owned by the manager, untracked textures read a counter that stays 0
+		const std::atomic<uint32_t>* m_pCurrentFrame{ nullptr };
+		//Bit per level taken by the reload in flight, decoded levels in the same order
+		uint32_t m_ReloadMask{};
+		std::vector<MipLevel> m_ReloadedLevels{};
+		bool m_IsReloading{ false };
+		std::atomic<bool> m_IsReloadDecoded{ false };
+		std::string m_Path{};
+		TexelLayout m_Layout{ TexelLayout::Linear };
+		TextureFormat m_Format{ TextureFormat::RGBA8 };
+		uint32_t m_Id{};
+		bool m_IsSRGB{ true };
+		const float* m_pByteToFloat{ nullptr };
+		TextureFilter m_Filter{ TextureFilter::Point };
+		AddressMode m_AddressMode{ AddressMode::Wrap };
 
-		SDL_Surface* m_pSurface{ nullptr };
-		uint32_t* m_pSurfacePixels{ nullptr };
+		SampleFunction m_pSample{ nullptr };
+		SampleSpanFunction m_pSampleSpan{ nullptr };
 	};
-}
\ No newline at end of file
+}
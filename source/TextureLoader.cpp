@@ -0,0 +1,86 @@
+#include "TextureLoader.h"
+
+namespace dae
+{
+	TextureHandle::TextureHandle(std::shared_ptr<const Texture> pPlaceholder) :
+		m_pPlaceholder{ std::move(pPlaceholder) },
+		m_pCurrent{ m_pPlaceholder.get() }
+	{
+	}
+
+	void TextureHandle::Publish(Texture* pTexture)
+	{
+		m_pLoaded.reset(pTexture);
+		m_pCurrent.store(pTexture, std::memory_order_release);
+		m_State.store(State::Ready, std::memory_order_release);
+	}
+
+	void TextureHandle::Fail()
+	{
+		m_State.store(State::Failed, std::memory_order_release);
+	}
+
+	TextureLoader::TextureLoader(JobSystem& jobSystem) :
+		m_JobSystem{ jobSystem },
+		m_pPlaceholder{ Texture::CreateSolid(colors::Gray) }
+	{
+	}
+
+	TextureLoader::~TextureLoader()
+	{
+		m_IsStopping.store(true, std::memory_order_relaxed);
+		m_JobSystem.Wait(m_Loads);
+	}
+
+	std::shared_ptr<TextureHandle> TextureLoader::LoadAsync(const std::string& path, const TextureLoadSettings& settings)
+	{
+		auto pHandle{ std::make_shared<TextureHandle>(m_pPlaceholder) };
+
+		//The job keeps the handle alive until the texture is published
+		m_JobSystem.SubmitBackground([this, path, settings, pHandle]() { Load(path, settings, *pHandle); }, m_Loads);
+
+		return pHandle;
+	}
+
+	bool TextureLoader::ReloadAsync(Texture& texture)
+	{
+		if (!texture.BeginReload())
+			return false;
+
+		//The texture is kept alive by its handle, whose owner waits for this loader before letting go of it
+		m_JobSystem.SubmitBackground([&texture]() { texture.DecodeReload(); }, m_Loads);
+		return true;
+	}
+
+	uint32_t TextureLoader::WaitIdle()
+	{
+		m_JobSystem.Wait(m_Loads);
+		return m_FailedCount.load(std::memory_order_relaxed);
+	}
+
+	void TextureLoader::Load(const std::string& path, const TextureLoadSettings& settings, TextureHandle& handle)
+	{
+		if (m_IsStopping.load(std::memory_order_relaxed))
+		{
+			handle.Fail();
+			return;
+		}
+
+		//Decode and configure fully before the handle can see the texture
+		Texture* pTexture{ settings.format == TextureFormat::RGBA8 ?
+			Texture::LoadFromFile(path, settings.layout, settings.colorSpace) :
+			Texture::LoadFromFile(path, settings.format, settings.colorSpace) };
+
+		if (pTexture)
+		{
+			pTexture->SetFilter(settings.filter);
+			pTexture->SetAddressMode(settings.addressMode);
+			handle.Publish(pTexture);
+		}
+		else
+		{
+			m_FailedCount.fetch_add(1, std::memory_order_relaxed);
+			handle.Fail();
+		}
+	}
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "JobSystem.h"
+#include "Texture.h"
+
+namespace dae
+{
+	struct TextureLoadSettings
+	{
+		TextureFormat format{ TextureFormat::RGBA8 };
+		TexelLayout layout{ TexelLayout::Linear };
+		//Color textures are sRGB, normal, roughness and mask maps are linear, BC5 has to be linear
+		TextureColorSpace colorSpace{ TextureColorSpace::SRGB };
+		TextureFilter filter{ TextureFilter::Point };
+		AddressMode addressMode{ AddressMode::Wrap };
+	};
+
+	//Samples a placeholder until the texture is loaded, then switches to it atomically
+	class TextureHandle final
+	{
+	public:
+		enum class State
+		{
+			Loading,
+			Ready,
+			Failed
+		};
+
+		explicit TextureHandle(std::shared_ptr<const Texture> pPlaceholder);
+
+		TextureHandle(const TextureHandle&) = delete;
+		TextureHandle(TextureHandle&&) noexcept = delete;
+		TextureHandle& operator=(const TextureHandle&) = delete;
+		TextureHandle& operator=(TextureHandle&&) noexcept = delete;
+
+		//Read once per frame, both textures stay alive as long as the handle does
+		const Texture& Get() const { return *m_pCurrent.load(std::memory_order_acquire); }
+		const Texture* operator->() const { return &Get(); }
+
+		State GetState() const { return m_State.load(std::memory_order_acquire); }
+		bool IsReady() const { return GetState() == State::Ready; }
+
+	private:
+		friend class TextureLoader;
+		friend class TextureManager;
+
+		void Publish(Texture* pTexture);
+		void Fail();
+
+		std::shared_ptr<const Texture> m_pPlaceholder{};
+		std::unique_ptr<Texture> m_pLoaded{};
+		std::atomic<const Texture*> m_pCurrent{ nullptr };
+		std::atomic<State> m_State{ State::Loading };
+	};
+
+	//Decodes textures as background jobs of the renderer's JobSystem, so loading never adds threads of its own
+	//and a frame waiting on its own jobs never picks up a decode
+	class TextureLoader final
+	{
+	public:
+		explicit TextureLoader(JobSystem& jobSystem);
+		//Waits for the loads in flight, those that did not start yet fail without decoding
+		~TextureLoader();
+
+		TextureLoader(const TextureLoader&) = delete;
+		TextureLoader(TextureLoader&&) noexcept = delete;
+		TextureLoader& operator=(const TextureLoader&) = delete;
+		TextureLoader& operator=(TextureLoader&&) noexcept = delete;
+
+		//Returns immediately, the handle samples a 1x1 placeholder until the file is decoded
+		std::shared_ptr<TextureHandle> LoadAsync(const std::string& path, const TextureLoadSettings& settings = {});
+
+		//Decodes the requested mip levels of an evicted texture again as a job, TextureManager installs them between frames
+		//False when no requested level is missing or a reload of the texture is still in flight
+		bool ReloadAsync(Texture& texture);
+
+		//Blocks until every queued texture is loaded or failed, returns how many failed since the loader was created
+		//The loads themselves only run on the workers, see JobSystem::SubmitBackground
+		uint32_t WaitIdle();
+
+	private:
+		void Load(const std::string& path, const TextureLoadSettings& settings, TextureHandle& handle);
+
+		JobSystem& m_JobSystem;
+		JobCounter m_Loads{};
+		std::shared_ptr<const Texture> m_pPlaceholder{};
+
+		std::atomic<uint32_t> m_FailedCount{};
+		std::atomic<bool> m_IsStopping{ false };
+	};
+}
@@ -0,0 +1,166 @@
+#include "TextureManager.h"
+#include "TextureLoader.h"
+#include <algorithm>
+#include <cassert>
+
+namespace dae
+{
+	TextureManager::TextureManager(size_t budgetBytes) :
+		m_Budget{ budgetBytes }
+	{
+	}
+
+	TextureManager& TextureManager::GetShared()
+	{
+		static TextureManager shared{ 64 * 1024 * 1024 };
+		return shared;
+	}
+
+	void TextureManager::Register(std::shared_ptr<TextureHandle> pTexture, TextureLoader& loader)
+	{
+		CheckOwnerThread();
+		m_Textures.emplace_back(TrackedTexture{ std::move(pTexture), &loader });
+	}
+
+	void TextureManager::Unregister(const std::shared_ptr<TextureHandle>& pTexture)
+	{
+		CheckOwnerThread();
+		for (const TrackedTexture& tracked : m_Textures)
+		{
+			if (tracked.pHandle == pTexture)
+				m_ReloadingSize -= tracked.reloadingSize;
+		}
+		m_Textures.erase(std::remove_if(m_Textures.begin(), m_Textures.end(),
+			[&pTexture](const TrackedTexture& tracked) { return tracked.pHandle == pTexture; }), m_Textures.end());
+	}
+
+	void TextureManager::Update()
+	{
+		CheckOwnerThread();
+
+		//Their bytes were reserved when they were queued, so installing them never exceeds the budget
+		for (TrackedTexture& tracked : m_Textures)
+		{
+			if (!tracked.pHandle->IsReady())
+				continue;
+
+			//Published by a worker after it was registered, from now on its samples stamp the frames of this manager
+			Texture* pTexture{ tracked.pHandle->m_pLoaded.get() };
+			pTexture->m_pCurrentFrame = &m_Frame;
+
+			if (pTexture->FinishReload())
+				++m_ReloadCount;
+			if (!pTexture->IsReloading())
+			{
+				m_ReloadingSize -= tracked.reloadingSize;
+				tracked.reloadingSize = 0;
+			}
+		}
+
+		//Textures that finished loading can push the resident levels over the cap, then even young levels go
+		EvictToFit(m_Budget, 0, false);
+
+		//Levels that had to fall back are decoded on the workers, frames sample the coarser level until they are installed
+		for (TrackedTexture& tracked : m_Textures)
+		{
+			Texture* pTexture{ tracked.pHandle->IsReady() ? tracked.pHandle->m_pLoaded.get() : nullptr };
+			if (!pTexture || pTexture->IsReloading() || !pTexture->HasRequestedMipLevels())
+				continue;
+
+			size_t reloadSize{};
+			for (int level{}; level < pTexture->GetMipLevelCount(); ++level)
+			{
+				if (pTexture->IsMipLevelRequested(level) && !pTexture->IsMipLevelResident(level))
+					reloadSize += pTexture->GetMipLevelSize(level);
+			}
+
+			//A reload never evicts what was sampled recently, it stays requested and waits for room instead
+			if (reloadSize > m_Budget || !EvictToFit(m_Budget - reloadSize, m_MinimumAge, true))
+				continue;
+
+			if (tracked.pLoader->ReloadAsync(*pTexture))
+			{
+				tracked.reloadingSize = reloadSize;
+				m_ReloadingSize += reloadSize;
+			}
+		}
+
+		m_Frame.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	size_t TextureManager::GetResidentSize() const
+	{
+		size_t size{};
+		for (const TrackedTexture& tracked : m_Textures)
+		{
+			if (tracked.pHandle->IsReady())
+				size += tracked.pHandle->m_pLoaded->GetMemorySize();
+		}
+		return size;
+	}
+
+	void TextureManager::CheckOwnerThread()
+	{
+		if (m_OwnerThread == std::thread::id{})
+			m_OwnerThread = std::this_thread::get_id();
+		assert(m_OwnerThread == std::this_thread::get_id() && "TextureManager used from a thread that does not own it");
+	}
+
+	bool TextureManager::EvictToFit(size_t budgetBytes, uint32_t minimumAge, bool isAllOrNothing)
+	{
+		size_t usedSize{ GetResidentSize() + m_ReloadingSize };
+		if (usedSize <= budgetBytes)
+			return true;
+
+		struct Candidate
+		{
+			Texture* pTexture{};
+			int level{};
+			uint32_t lastUsedFrame{};
+		};
+
+		//Every resident level except the coarsest one of each texture
+		const uint32_t frame{ m_Frame.load(std::memory_order_relaxed) };
+		std::vector<Candidate> candidates{};
+		size_t evictableSize{};
+		for (const TrackedTexture& tracked : m_Textures)
+		{
+			Texture* pTexture{ tracked.pHandle->IsReady() ? tracked.pHandle->m_pLoaded.get() : nullptr };
+			if (!pTexture || !pTexture->IsEvictable())
+				continue;
+
+			for (int level{}; level < pTexture->GetMipLevelCount() - 1; ++level)
+			{
+				const uint32_t lastUsedFrame{ pTexture->GetMipLevelLastUsedFrame(level) };
+				if (pTexture->IsMipLevelResident(level) && frame - lastUsedFrame >= minimumAge)
+				{
+					candidates.emplace_back(Candidate{ pTexture, level, lastUsedFrame });
+					evictableSize += pTexture->GetMipLevelSize(level);
+				}
+			}
+		}
+
+		//Part of the room a reload needs would only lose levels, the reload still could not start
+		if (isAllOrNothing && usedSize - evictableSize > budgetBytes)
+			return false;
+
+		//Oldest first, the finer and larger level first within a frame
+		std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b)
+			{
+				if (a.lastUsedFrame != b.lastUsedFrame)
+					return a.lastUsedFrame < b.lastUsedFrame;
+				return a.level < b.level;
+			});
+
+		for (const Candidate& candidate : candidates)
+		{
+			if (usedSize <= budgetBytes)
+				break;
+
+			usedSize -= candidate.pTexture->GetMipLevelSize(candidate.level);
+			candidate.pTexture->EvictMipLevel(candidate.level);
+			++m_EvictionCount;
+		}
+		return usedSize <= budgetBytes;
+	}
+}
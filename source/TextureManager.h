@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace dae
+{
+	class TextureHandle;
+	class TextureLoader;
+
+	//Keeps the mip levels of its textures and the reloads in flight under a memory budget, least recently sampled levels are evicted first
+	//Sampled levels are stamped with the frame of the manager, so textures of different managers never compare frames
+	//Owned by the first thread that registers or updates, every call but the getters has to come from that thread
+	class TextureManager final
+	{
+	public:
+		explicit TextureManager(size_t budgetBytes);
+		~TextureManager() = default;
+
+		//Shared by every renderer of the process to cap the process as a whole
+		//The application updates it once per frame of the process, not once per renderer
+		static TextureManager& GetShared();
+
+		TextureManager(const TextureManager&) = delete;
+		TextureManager(TextureManager&&) noexcept = delete;
+		TextureManager& operator=(const TextureManager&) = delete;
+		TextureManager& operator=(TextureManager&&) noexcept = delete;
+
+		//Textures are tracked once their handle is ready, textures without a source file are counted but never evicted
+		//Evicted levels are decoded again by the loader, it has to outlive the registration
+		void Register(std::shared_ptr<TextureHandle> pTexture, TextureLoader& loader);
+		//Its levels no longer count against the budget and are never evicted again
+		//Reloads in flight have to be finished, the owner waits for the loader first
+		void Unregister(const std::shared_ptr<TextureHandle>& pTexture);
+
+		//Call once per frame of the process while no renderer samples, installs finished reloads,
+		//evicts until the budget holds, then queues the reloads that fit and advances the frame
+		void Update();
+
+		size_t GetBudget() const { return m_Budget; }
+		void SetBudget(size_t budgetBytes) { m_Budget = budgetBytes; }
+		//Reloads only make room by evicting levels sampled at least this many frames ago, otherwise they wait
+		//The budget itself is a hard cap, levels of any age are evicted when the resident ones alone exceed it
+		uint32_t GetMinimumAge() const { return m_MinimumAge; }
+		void SetMinimumAge(uint32_t frames) { m_MinimumAge = frames; }
+		//Bytes held by the mip levels of all ready textures
+		size_t GetResidentSize() const;
+		//Bytes reserved by the reloads in flight, counted against the budget before they are installed
+		size_t GetReloadingSize() const { return m_ReloadingSize; }
+		uint32_t GetEvictionCount() const { return m_EvictionCount; }
+		uint32_t GetReloadCount() const { return m_ReloadCount; }
+
+	private:
+		struct TrackedTexture
+		{
+			std::shared_ptr<TextureHandle> pHandle{};
+			TextureLoader* pLoader{};
+			size_t reloadingSize{};
+		};
+
+		void CheckOwnerThread();
+		//Evicts levels at least minimumAge frames old until resident and reloading bytes fit in budgetBytes
+		//All or nothing evicts only when that is enough to fit
+		bool EvictToFit(size_t budgetBytes, uint32_t minimumAge, bool isAllOrNothing);
+
+		std::vector<TrackedTexture> m_Textures{};
+		size_t m_Budget{};
+		uint32_t m_MinimumAge{ 4 };
+		size_t m_ReloadingSize{};
+		std::thread::id m_OwnerThread{};
+		//Read by every sample of the tracked textures, only written by Update
+		std::atomic<uint32_t> m_Frame{};
+		uint32_t m_EvictionCount{};
+		uint32_t m_ReloadCount{};
+	};
+}
@@ -0,0 +1,53 @@
+#include "TileBinner.h"
+#include <algorithm>
+#include <iterator>
+
+#include "FrameArena.h"
+
+namespace dae
+{
+	TileBinner::TileBinner(int width, int height, int tileSize) :
+		m_Width{ width },
+		m_Height{ height },
+		m_TileSize{ tileSize },
+		m_TilesPerRow{ (width + tileSize - 1) / tileSize },
+		m_TileCount{ m_TilesPerRow * ((height + tileSize - 1) / tileSize) }
+	{
+	}
+
+	void TileBinner::GetTileBounds(int tileIndex, Int2& tileMin, Int2& tileMax) const
+	{
+		tileMin.x = (tileIndex % m_TilesPerRow) * m_TileSize;
+		tileMin.y = (tileIndex / m_TilesPerRow) * m_TileSize;
+		tileMax.x = std::min(tileMin.x + m_TileSize, m_Width) - 1;
+		tileMax.y = std::min(tileMin.y + m_TileSize, m_Height) - 1;
+	}
+
+	void TileBinner::Reset(FrameArena& arena, uint32_t threadIndex, uint32_t chunkCount)
+	{
+		m_pArena = &arena;
+		m_pBins = arena.Allocate<Bin>(threadIndex, size_t(chunkCount) * m_TileCount);
+		m_ChunkCount = chunkCount;
+	}
+
+	void TileBinner::Add(uint32_t threadIndex, uint32_t chunkIndex, uint32_t triangleIndex, const Int2& boundsMin, const Int2& boundsMax)
+	{
+		Bin* pChunkBins{ m_pBins + size_t(chunkIndex) * m_TileCount };
+
+		for (int tileY{ boundsMin.y / m_TileSize }; tileY <= boundsMax.y / m_TileSize; ++tileY)
+		{
+			for (int tileX{ boundsMin.x / m_TileSize }; tileX <= boundsMax.x / m_TileSize; ++tileX)
+			{
+				Bin& bin{ pChunkBins[tileY * m_TilesPerRow + tileX] };
+				if (!bin.pLast || bin.pLast->count == std::size(bin.pLast->triangleIndices))
+				{
+					BinBlock* pBlock{ m_pArena->Allocate<BinBlock>(threadIndex, 1) };
+					(bin.pLast ? bin.pLast->pNext : bin.pFirst) = pBlock;
+					bin.pLast = pBlock;
+				}
+
+				bin.pLast->triangleIndices[bin.pLast->count++] = triangleIndex;
+			}
+		}
+	}
+}
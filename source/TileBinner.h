@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+
+#include "MathHelpers.h"
+
+namespace dae
+{
+	class FrameArena;
+
+	//Sorts triangles into the screen tiles their bounds touch, for a raster that works tile by tile
+	//Every chunk of triangles has bins of its own, so chunks are binned on different threads without locks,
+	//reading a tile chunk by chunk gives back the order the triangles were submitted in
+	class TileBinner final
+	{
+	public:
+		TileBinner() = default;
+		TileBinner(int width, int height, int tileSize = 64);
+
+		int GetTileCount() const { return m_TileCount; }
+		int GetTileSize() const { return m_TileSize; }
+
+		//Inclusive pixel bounds of a tile, the last row and column are cut off by the screen
+		void GetTileBounds(int tileIndex, Int2& tileMin, Int2& tileMax) const;
+
+		//Starts empty bins for this frame in the arena, they are gone once it is reset
+		void Reset(FrameArena& arena, uint32_t threadIndex, uint32_t chunkCount);
+
+		//Inclusive pixel bounds, already clamped to the screen
+		//Only one thread may add to a chunk at a time, its bins grow in that thread's sub-arena
+		void Add(uint32_t threadIndex, uint32_t chunkIndex, uint32_t triangleIndex, const Int2& boundsMin, const Int2& boundsMax);
+
+		//Calls function(triangleIndex) for every triangle of the tile, in submission order
+		template<typename Function>
+		void ForEachTriangle(int tileIndex, Function&& function) const
+		{
+			for (uint32_t chunkIndex{}; chunkIndex < m_ChunkCount; ++chunkIndex)
+			{
+				for (const BinBlock* pBlock{ m_pBins[size_t(chunkIndex) * m_TileCount + tileIndex].pFirst }; pBlock; pBlock = pBlock->pNext)
+				{
+					for (uint32_t i{}; i < pBlock->count; ++i)
+						function(pBlock->triangleIndices[i]);
+				}
+			}
+		}
+
+	private:
+		//Two cache lines of triangle indices, 128 bytes with the count and link
+		struct BinBlock
+		{
+			uint32_t triangleIndices[29]{};
+			uint32_t count{};
+			BinBlock* pNext{};
+		};
+
+		struct Bin
+		{
+			BinBlock* pFirst{};
+			BinBlock* pLast{};
+		};
+
+		int m_Width{};
+		int m_Height{};
+		int m_TileSize{};
+		int m_TilesPerRow{};
+		int m_TileCount{};
+
+		//Chunk major, the bins of one chunk are next to each other
+		FrameArena* m_pArena{ nullptr };
+		Bin* m_pBins{ nullptr };
+		uint32_t m_ChunkCount{};
+	};
+}
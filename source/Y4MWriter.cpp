@@ -0,0 +1,191 @@
+#include "Y4MWriter.h"
+
+//External includes
+#include <SDL_pixels.h>
+
+//Standard includes
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace dae
+{
+	namespace
+	{
+		//BT.601 limited range in 8.8 fixed point, the SSE path below uses the same rounding
+		uint8_t ToLuma(int r, int g, int b)
+		{
+			return uint8_t(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+		}
+
+		uint8_t ToU(int r, int g, int b)
+		{
+			return uint8_t(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+		}
+
+		uint8_t ToV(int r, int g, int b)
+		{
+			return uint8_t(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+		}
+
+		//One channel of eight pixels as 16 bit lanes
+		__m128i ExtractChannel(__m128i pixels0, __m128i pixels1, __m128i shift)
+		{
+			const __m128i mask{ _mm_set1_epi32(0xFF) };
+			return _mm_packs_epi32(_mm_and_si128(_mm_srl_epi32(pixels0, shift), mask), _mm_and_si128(_mm_srl_epi32(pixels1, shift), mask));
+		}
+
+		//Sums of horizontal pairs of two rows, rounded to their average, in the lower four lanes
+		__m128i AverageQuads(__m128i row0, __m128i row1)
+		{
+			const __m128i pairSums{ _mm_madd_epi16(_mm_add_epi16(row0, row1), _mm_set1_epi16(1)) };
+			const __m128i sums{ _mm_packs_epi32(pairSums, pairSums) };
+			return _mm_srli_epi16(_mm_add_epi16(sums, _mm_set1_epi16(2)), 2);
+		}
+
+		//Coefficients fit in 16 bits and luma sums stay below 65536, so the low half of each product is exact
+		__m128i WeightedSum(__m128i r, __m128i g, __m128i b, short weightR, short weightG, short weightB)
+		{
+			return _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(weightR)), _mm_mullo_epi16(g, _mm_set1_epi16(weightG))),
+				_mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(weightB)), _mm_set1_epi16(128)));
+		}
+	}
+
+	Y4MWriter::Y4MWriter(const std::string& path, int width, int height, const SDL_PixelFormat* pFormat, int frameRate) :
+		m_Width{ width },
+		m_Height{ height },
+		m_ChromaWidth{ (width + 1) / 2 },
+		m_ChromaHeight{ (height + 1) / 2 },
+		m_RedShift{ pFormat->Rshift },
+		m_GreenShift{ pFormat->Gshift },
+		m_BlueShift{ pFormat->Bshift }
+	{
+		if (path == "-")
+		{
+#ifdef _WIN32
+			//Text mode would turn every 0x0A into 0x0D 0x0A
+			_setmode(_fileno(stdout), _O_BINARY);
+#endif
+			m_pFile = stdout;
+		}
+		else
+		{
+			m_pFile = std::fopen(path.c_str(), "wb");
+			if (!m_pFile)
+				return;
+		}
+
+		m_Planes.resize(size_t(m_Width) * m_Height + size_t(m_ChromaWidth) * m_ChromaHeight * 2);
+		std::fprintf(m_pFile, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", m_Width, m_Height, frameRate);
+	}
+
+	Y4MWriter::~Y4MWriter()
+	{
+		if (!m_pFile)
+			return;
+
+		if (m_pFile == stdout)
+			std::fflush(m_pFile);
+		else
+			std::fclose(m_pFile);
+	}
+
+	bool Y4MWriter::WriteFrame(const uint32_t* pPixels)
+	{
+		if (!m_pFile)
+			return false;
+
+		uint8_t* pLuma{ m_Planes.data() };
+		uint8_t* pU{ pLuma + size_t(m_Width) * m_Height };
+		uint8_t* pV{ pU + size_t(m_ChromaWidth) * m_ChromaHeight };
+
+		//Rows in pairs, an odd last row pairs with itself
+		for (int chromaY{}; chromaY < m_ChromaHeight; ++chromaY)
+		{
+			const int y0{ chromaY * 2 };
+			const int y1{ std::min(y0 + 1, m_Height - 1) };
+			ConvertRows(pPixels + size_t(y0) * m_Width, pPixels + size_t(y1) * m_Width,
+				pLuma + size_t(y0) * m_Width, pLuma + size_t(y1) * m_Width,
+				pU + size_t(chromaY) * m_ChromaWidth, pV + size_t(chromaY) * m_ChromaWidth);
+		}
+
+		std::fputs("FRAME\n", m_pFile);
+		return std::fwrite(m_Planes.data(), 1, m_Planes.size(), m_pFile) == m_Planes.size();
+	}
+
+	void Y4MWriter::ConvertRows(const uint32_t* pRow0, const uint32_t* pRow1, uint8_t* pLuma0, uint8_t* pLuma1, uint8_t* pU, uint8_t* pV) const
+	{
+		const __m128i redShift{ _mm_cvtsi32_si128(int(m_RedShift)) };
+		const __m128i greenShift{ _mm_cvtsi32_si128(int(m_GreenShift)) };
+		const __m128i blueShift{ _mm_cvtsi32_si128(int(m_BlueShift)) };
+
+		//Eight pixels of both rows, four chroma samples at a time
+		int x{};
+		for (; x + 8 <= m_Width; x += 8)
+		{
+			const __m128i row0Pixels0{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow0 + x)) };
+			const __m128i row0Pixels1{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow0 + x + 4)) };
+			const __m128i row1Pixels0{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow1 + x)) };
+			const __m128i row1Pixels1{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow1 + x + 4)) };
+
+			const __m128i r0{ ExtractChannel(row0Pixels0, row0Pixels1, redShift) };
+			const __m128i g0{ ExtractChannel(row0Pixels0, row0Pixels1, greenShift) };
+			const __m128i b0{ ExtractChannel(row0Pixels0, row0Pixels1, blueShift) };
+			const __m128i r1{ ExtractChannel(row1Pixels0, row1Pixels1, redShift) };
+			const __m128i g1{ ExtractChannel(row1Pixels0, row1Pixels1, greenShift) };
+			const __m128i b1{ ExtractChannel(row1Pixels0, row1Pixels1, blueShift) };
+
+			const __m128i lumaOffset{ _mm_set1_epi16(16) };
+			const __m128i luma0{ _mm_add_epi16(_mm_srli_epi16(WeightedSum(r0, g0, b0, 66, 129, 25), 8), lumaOffset) };
+			const __m128i luma1{ _mm_add_epi16(_mm_srli_epi16(WeightedSum(r1, g1, b1, 66, 129, 25), 8), lumaOffset) };
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(pLuma0 + x), _mm_packus_epi16(luma0, luma0));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(pLuma1 + x), _mm_packus_epi16(luma1, luma1));
+
+			const __m128i r{ AverageQuads(r0, r1) };
+			const __m128i g{ AverageQuads(g0, g1) };
+			const __m128i b{ AverageQuads(b0, b1) };
+
+			//Chroma sums can be negative, an arithmetic shift keeps the sign
+			const __m128i chromaOffset{ _mm_set1_epi16(128) };
+			const __m128i u{ _mm_add_epi16(_mm_srai_epi16(WeightedSum(r, g, b, -38, -74, 112), 8), chromaOffset) };
+			const __m128i v{ _mm_add_epi16(_mm_srai_epi16(WeightedSum(r, g, b, 112, -94, -18), 8), chromaOffset) };
+			const int packedU{ _mm_cvtsi128_si32(_mm_packus_epi16(u, u)) };
+			const int packedV{ _mm_cvtsi128_si32(_mm_packus_epi16(v, v)) };
+			std::memcpy(pU + x / 2, &packedU, sizeof(packedU));
+			std::memcpy(pV + x / 2, &packedV, sizeof(packedV));
+		}
+
+		//Leftover pixels, an odd last column pairs with itself
+		const auto channels = [this](uint32_t pixel, int& r, int& g, int& b)
+		{
+			r = int((pixel >> m_RedShift) & 0xFF);
+			g = int((pixel >> m_GreenShift) & 0xFF);
+			b = int((pixel >> m_BlueShift) & 0xFF);
+		};
+
+		for (; x < m_Width; x += 2)
+		{
+			const int x1{ std::min(x + 1, m_Width - 1) };
+			int r[4]{}, g[4]{}, b[4]{};
+			channels(pRow0[x], r[0], g[0], b[0]);
+			channels(pRow0[x1], r[1], g[1], b[1]);
+			channels(pRow1[x], r[2], g[2], b[2]);
+			channels(pRow1[x1], r[3], g[3], b[3]);
+
+			pLuma0[x] = ToLuma(r[0], g[0], b[0]);
+			pLuma0[x1] = ToLuma(r[1], g[1], b[1]);
+			pLuma1[x] = ToLuma(r[2], g[2], b[2]);
+			pLuma1[x1] = ToLuma(r[3], g[3], b[3]);
+
+			const int averageR{ (r[0] + r[1] + r[2] + r[3] + 2) >> 2 };
+			const int averageG{ (g[0] + g[1] + g[2] + g[3] + 2) >> 2 };
+			const int averageB{ (b[0] + b[1] + b[2] + b[3] + 2) >> 2 };
+			pU[x / 2] = ToU(averageR, averageG, averageB);
+			pV[x / 2] = ToV(averageR, averageG, averageB);
+		}
+	}
+}
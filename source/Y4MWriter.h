@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct SDL_PixelFormat;
+
+namespace dae
+{
+	//Streams frames as YUV4MPEG2 with 4:2:0 BT.601 limited range chroma, for piping into an external encoder
+	class Y4MWriter final
+	{
+	public:
+		//"-" writes to stdout, any other path is opened as a file, which can be a named pipe or /dev/fd/N
+		Y4MWriter(const std::string& path, int width, int height, const SDL_PixelFormat* pFormat, int frameRate = 30);
+		~Y4MWriter();
+
+		Y4MWriter(const Y4MWriter&) = delete;
+		Y4MWriter(Y4MWriter&&) noexcept = delete;
+		Y4MWriter& operator=(const Y4MWriter&) = delete;
+		Y4MWriter& operator=(Y4MWriter&&) noexcept = delete;
+
+		bool IsOpen() const { return m_pFile != nullptr; }
+		bool IsStdout() const { return m_pFile == stdout; }
+
+		//Converts width * height packed pixels and writes them, blocks while a pipe is full
+		bool WriteFrame(const uint32_t* pPixels);
+
+	private:
+		void ConvertRows(const uint32_t* pRow0, const uint32_t* pRow1, uint8_t* pLuma0, uint8_t* pLuma1, uint8_t* pU, uint8_t* pV) const;
+
+		FILE* m_pFile{ nullptr };
+		int m_Width{};
+		int m_Height{};
+		int m_ChromaWidth{};
+		int m_ChromaHeight{};
+		uint32_t m_RedShift{};
+		uint32_t m_GreenShift{};
+		uint32_t m_BlueShift{};
+
+		//Y, U and V planes back to back, the layout of a frame on the wire
+		std::vector<uint8_t> m_Planes{};
+	};
+}
@@ -5,11 +5,18 @@
 #undef main
 
 //Standard includes
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <string>
 
 //Project includes
 #include "Timer.h"
 #include "Renderer.h"
+#include "TextureManager.h"
+#include "Benchmark.h"
+#include "BatchRender.h"
+#include "FrameWriter.h"
 
 using namespace dae;
 
@@ -21,9 +28,66 @@ void ShutDown(SDL_Window* pWindow)
 
 int main(int argc, char* args[])
 {
-	//Unreferenced parameters
-	(void)argc;
-	(void)args;
+	//Command line
+	//In front of everything else, in any order:
+	//--workers <count> sets the renderer's worker threads, 0 picks them from the hardware
+	//--pin-workers keeps every worker on one core, only worth it when nothing else runs on the machine
+	uint32_t workerCount{};
+	bool isPinned{ false };
+	while (argc > 1)
+	{
+		if (argc > 2 && std::string(args[1]) == "--workers")
+		{
+			workerCount = uint32_t(std::max(std::atoi(args[2]), 0));
+			argc -= 2;
+			args += 2;
+		}
+		else if (std::string(args[1]) == "--pin-workers")
+		{
+			isPinned = true;
+			--argc;
+			++args;
+		}
+		else
+			break;
+	}
+
+	if (argc > 1 && std::string(args[1]) == "--benchmark")
+	{
+		Benchmark::RunAll();
+		return 0;
+	}
+	//--camera-path <file> [output prefix] [width] [height] [bmp|ppm|png|y4m]
+	//y4m streams one video to the output, "-" for stdout, instead of numbered images
+	if (argc > 2 && std::string(args[1]) == "--camera-path")
+	{
+		const std::string output{ argc > 3 ? args[3] : "frame_" };
+		const int width{ argc > 4 ? std::atoi(args[4]) : 640 };
+		const int height{ argc > 5 ? std::atoi(args[5]) : 480 };
+		if (width <= 0 || height <= 0)
+		{
+			std::cerr << "Invalid frame size" << std::endl;
+			return 1;
+		}
+
+		const std::string extension{ argc > 6 ? args[6] : "bmp" };
+		if (extension == "y4m")
+			return BatchRender::RenderCameraPathToY4M(args[2], output, width, height, 30, workerCount, isPinned) ? 0 : 1;
+
+		ImageFormat format{ ImageFormat::BMP };
+		if (extension == "ppm")
+			format = ImageFormat::PPM;
+		else if (extension == "png")
+			format = ImageFormat::PNG;
+		else if (extension != "bmp")
+		{
+			std::cerr << "Unknown format " << extension << '\n'
+				<< "Usage: --camera-path <file> [output prefix] [width] [height] [bmp|ppm|png|y4m]" << std::endl;
+			return 1;
+		}
+
+		return BatchRender::RenderCameraPath(args[2], output, width, height, format, workerCount, isPinned) ? 0 : 1;
+	}
 
 	//Create window + surfaces
 	SDL_Init(SDL_INIT_VIDEO);
@@ -42,7 +106,10 @@ int main(int argc, char* args[])
 
 	//Initialize "framework"
 	const auto pTimer = new Timer();
-	const auto pRenderer = new Renderer(pWindow);
+	const auto pRenderer = new Renderer(pWindow, workerCount, isPinned);
+	//Encodes screenshots off the main thread, one encoder keeps them in order on the same file
+	const auto pScreenshotWriter = new FrameWriter(width, height, pRenderer->GetBackBuffer()->format, ImageFormat::BMP, 2, 1);
+	uint32_t screenshotFailedCount{};
 
 	//Start loop
 	pTimer->Start();
@@ -63,11 +130,32 @@ int main(int argc, char* args[])
 			case SDL_KEYUP:
 				if (e.key.keysym.scancode == SDL_SCANCODE_X)
 					takeScreenshot = true;
+				//Cycle float32, unorm24 and unorm16 depth
+				if (e.key.keysym.scancode == SDL_SCANCODE_F2)
+				{
+					const DepthFormat format{ DepthFormat((int(pRenderer->GetDepthFormat()) + 1) % 3) };
+					pRenderer->SetDepthFormat(format, pRenderer->IsDepthReversed());
+					std::cout << "Depth format: " << (format == DepthFormat::Float32 ? "float32" : format == DepthFormat::Unorm24 ? "unorm24" : "unorm16") << std::endl;
+				}
+				//Toggle reversed depth
+				if (e.key.keysym.scancode == SDL_SCANCODE_F3)
+				{
+					pRenderer->SetDepthFormat(pRenderer->GetDepthFormat(), !pRenderer->IsDepthReversed());
+					std::cout << "Reversed depth: " << (pRenderer->IsDepthReversed() ? "on" : "off") << std::endl;
+				}
+				//Toggle overlapping geometry of the next frame with raster of the current one
+				if (e.key.keysym.scancode == SDL_SCANCODE_F4)
+				{
+					pRenderer->SetFramePipelining(!pRenderer->IsFramePipelined());
+					std::cout << "Frame pipelining: " << (pRenderer->IsFramePipelined() ? "on" : "off") << std::endl;
+				}
 				break;
 			}
 		}
 
 		//--------- Update ---------
+		//Once per frame of the process, before any renderer samples again
+		TextureManager::GetShared().Update();
 		pRenderer->Update(pTimer);
 
 		//--------- Render ---------
@@ -85,16 +173,21 @@ int main(int argc, char* args[])
 		//Save screenshot after full render
 		if (takeScreenshot)
 		{
-			if (!pRenderer->SaveBufferToImage())
-				std::cout << "Screenshot saved!" << std::endl;
-			else
-				std::cout << "Something went wrong. Screenshot not saved!" << std::endl;
+			pScreenshotWriter->Submit(pRenderer->GetPixels(), "Rasterizer_ColorBuffer.bmp");
+			std::cout << "Saving screenshot..." << std::endl;
 			takeScreenshot = false;
 		}
+		if (pScreenshotWriter->GetFailedCount() != screenshotFailedCount)
+		{
+			screenshotFailedCount = pScreenshotWriter->GetFailedCount();
+			std::cout << "Something went wrong. Screenshot not saved!" << std::endl;
+		}
 	}
 	pTimer->Stop();
 
 	//Shutdown "framework"
+	//Writes the screenshots still waiting for the encoder
+	delete pScreenshotWriter;
 	delete pRenderer;
 	delete pTimer;
 